@@ -0,0 +1,79 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <Eigen/Core>
+#include <unsupported/Eigen/CXX11/Tensor>
+
+#include "IO/readPLY.h"
+
+#include "mesh/sampleSurface.h"
+#include "sdf.h"
+#include "collisionSDF.h"
+
+// time one batch, in milliseconds per batch and nanoseconds per primitive
+template <typename Query>
+void benchmark(std::string name, long int batch_size, int repetitions, Query query) {
+    query();    // warm up
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i=0; i<repetitions; i++)
+        query();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / repetitions;
+
+    std::cout << name << ": " << seconds * 1e3 << " ms per batch of " << batch_size
+              << ", " << seconds * 1e9 / batch_size << " ns per primitive\n";
+};
+
+int main() {
+    int grid_resolution = 100;
+    double bounding_box_scale = 1.2;
+    long int batch_size = 1000000;
+    int repetitions = 5;
+
+    // IO: load files
+    std::cout << "Progress: load data\n";
+    Eigen::MatrixXd V, samples_V;
+    Eigen::MatrixXi F;
+    Eigen::MatrixXd N, samples_N;
+    Eigen::MatrixXi RGB;
+
+    readPLY("../data/Lucy100k.ply", V, F, N, RGB);
+
+    double leaf_size = getLeafSize(V, grid_resolution, bounding_box_scale);
+    sample_surface(V, F, leaf_size/2, samples_V, samples_N);
+
+    SDF sdf(samples_V, samples_N, grid_resolution, bounding_box_scale);
+
+    // random primitives in the bounding box, a few voxels large
+    Eigen::Vector3d min_point, max_point;
+    getMinMax(V, min_point, max_point);
+    Eigen::MatrixXd centers = (Eigen::MatrixXd::Random(3, batch_size).array() + 1) / 2;
+    centers = (centers.array().colwise() * (max_point - min_point).array()).colwise() + min_point.array();
+
+    Eigen::VectorXd radii = Eigen::VectorXd::Constant(batch_size, 2 * leaf_size);
+    Eigen::MatrixXd second_points = centers + 4 * leaf_size * Eigen::MatrixXd::Random(3, batch_size);
+    Eigen::MatrixXd half_extents = leaf_size * (Eigen::MatrixXd::Random(3, batch_size).array() + 2);
+    std::vector< Eigen::Matrix3d > rotations(batch_size);
+    for (long int i=0; i<batch_size; i++)
+        rotations[i] = Eigen::AngleAxisd(M_PI * i / batch_size, Eigen::Vector3d(1, 2, 3).normalized()).toRotationMatrix();
+
+    Eigen::VectorXd penetrations;
+    Eigen::MatrixXd normals;
+
+    std::cout << "Progress: benchmark\n";
+    benchmark("spheres", batch_size, repetitions, [&]() {
+        collide_spheres(sdf, centers, radii, penetrations, normals);
+    });
+    std::cout << "  in contact: " << (penetrations.array() > 0).count() << std::endl;
+
+    benchmark("capsules", batch_size, repetitions, [&]() {
+        collide_capsules(sdf, centers, second_points, radii, penetrations, normals);
+    });
+    std::cout << "  in contact: " << (penetrations.array() > 0).count() << std::endl;
+
+    benchmark("boxes", batch_size, repetitions, [&]() {
+        collide_boxes(sdf, centers, rotations, half_extents, penetrations, normals);
+    });
+    std::cout << "  in contact: " << (penetrations.array() > 0).count() << std::endl;
+
+    return 0;
+}
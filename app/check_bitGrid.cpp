@@ -0,0 +1,176 @@
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <Eigen/Core>
+#include <unsupported/Eigen/CXX11/Tensor>
+
+#include "bitGrid.h"
+#include "sdf.h"
+
+// random occupancy, each voxel occupied with the given probability
+Eigen::Tensor<bool, 3> make_random_grid(int nx, int ny, int nz, double probability) {
+    Eigen::Tensor<bool, 3> grid(nx, ny, nz);
+    for (long int i = 0; i < grid.size(); ++i)
+        grid.data()[i] = std::rand() < probability * RAND_MAX;
+    return grid;
+};
+
+// voxel offsets of a structuring element of radius 1 (6, 18 and 26
+// neighbourhoods) or of the euclidean ball of the given radius
+std::vector< Eigen::Vector3i > element_offsets(StructuringElement element, int radius) {
+    const int extent = element == SPHERICAL ? radius : 1;
+    std::vector< Eigen::Vector3i > offsets;
+    for (int dz = -extent; dz <= extent; ++dz)
+        for (int dy = -extent; dy <= extent; ++dy)
+            for (int dx = -extent; dx <= extent; ++dx) {
+                const int l1 = std::abs(dx) + std::abs(dy) + std::abs(dz);
+                bool in_element = false;
+                switch (element) {
+                    case CONNECTIVITY_6:  in_element = l1 <= 1; break;
+                    case CONNECTIVITY_18: in_element = l1 <= 2; break;
+                    case CONNECTIVITY_26: in_element = true; break;
+                    case SPHERICAL:       in_element = dx*dx + dy*dy + dz*dz <= radius*radius; break;
+                }
+                if (in_element)
+                    offsets.push_back(Eigen::Vector3i(dx, dy, dz));
+            }
+    return offsets;
+};
+
+// brute force dilation or erosion, voxel by voxel, the voxels outside the grid are empty
+Eigen::Tensor<bool, 3> reference_pass(const Eigen::Tensor<bool, 3> & in, const std::vector< Eigen::Vector3i > & offsets, bool dilation) {
+    Eigen::Tensor<bool, 3> out(in.dimension(0), in.dimension(1), in.dimension(2));
+    for (int z = 0; z < in.dimension(2); ++z)
+        for (int y = 0; y < in.dimension(1); ++y)
+            for (int x = 0; x < in.dimension(0); ++x) {
+                bool value = !dilation;
+                for (int i = 0; i < offsets.size(); ++i) {
+                    const Eigen::Vector3i p = Eigen::Vector3i(x, y, z) + offsets[i];
+                    const bool inside = p(0) >= 0 && p(0) < in.dimension(0) && p(1) >= 0 && p(1) < in.dimension(1) && p(2) >= 0 && p(2) < in.dimension(2);
+                    const bool occupied = inside && in(p(0), p(1), p(2));
+                    value = dilation ? value || occupied : value && occupied;
+                }
+                out(x, y, z) = value;
+            }
+    return out;
+};
+
+// the neighbourhoods are applied radius times, the ball once
+Eigen::Tensor<bool, 3> reference_morphology(const Eigen::Tensor<bool, 3> & in, StructuringElement element, int radius, bool dilation) {
+    const std::vector< Eigen::Vector3i > offsets = element_offsets(element, radius);
+    Eigen::Tensor<bool, 3> out = reference_pass(in, offsets, dilation);
+    for (int i = 1; i < (element == SPHERICAL ? 1 : radius); ++i)
+        out = reference_pass(out, offsets, dilation);
+    return out;
+};
+
+bool equal(const BitGrid & grid, const Eigen::Tensor<bool, 3> & expected) {
+    Eigen::Tensor<bool, 3> tensor;
+    grid.to_tensor(tensor);
+    Eigen::Tensor<bool, 0> same = (tensor == expected).all();
+    return same();
+};
+
+int failures = 0;
+
+void check(bool condition, std::string description) {
+    if (!condition) {
+        std::cout << "Error: " << description << std::endl;
+        failures++;
+    }
+};
+
+// analytic SDF of a ball, sampled on the same grid for every ball
+SDF make_ball(double radius, const Eigen::Vector3d & center, const Eigen::Vector3i & number_of_bins, double grid_size) {
+    const Eigen::Vector3d source = Eigen::Vector3d::Constant(-1);
+    Eigen::Tensor<double, 3> grid(number_of_bins(0), number_of_bins(1), number_of_bins(2));
+    for (int z = 0; z < number_of_bins(2); ++z)
+        for (int y = 0; y < number_of_bins(1); ++y)
+            for (int x = 0; x < number_of_bins(0); ++x)
+                grid(x, y, z) = radius - (Eigen::Vector3d(x, y, z) * grid_size + source - center).norm();
+    return SDF(grid, grid_size, source);
+};
+
+int main() {
+    std::srand(7);
+
+    // rows of two words with a partial last one, sparse and dense occupancy
+    const char * element_names[] = {"6 neighbourhood", "18 neighbourhood", "26 neighbourhood", "sphere"};
+    const StructuringElement elements[] = {CONNECTIVITY_6, CONNECTIVITY_18, CONNECTIVITY_26, SPHERICAL};
+    const double probabilities[] = {0.03, 0.97};
+
+    for (int p = 0; p < 2; ++p) {
+        const Eigen::Tensor<bool, 3> grid = make_random_grid(77, 13, 11, probabilities[p]);
+        const BitGrid bit_grid(grid);
+        check(equal(bit_grid, grid), "packing round trip");
+        Eigen::Tensor<long int, 0> occupied = grid.cast<long int>().sum();
+        check(bit_grid.count() == occupied(), "wrong count of occupied voxels");
+
+        for (int e = 0; e < 4; ++e)
+            for (int radius = 1; radius <= 3; ++radius) {
+                const std::string name = std::string(element_names[e]) + ", radius " + std::to_string(radius) + ", occupancy " + std::to_string(probabilities[p]);
+                const Eigen::Tensor<bool, 3> dilated = reference_morphology(grid, elements[e], radius, true);
+                const Eigen::Tensor<bool, 3> eroded = reference_morphology(grid, elements[e], radius, false);
+
+                BitGrid out;
+                dilate(bit_grid, out, elements[e], radius);
+                check(equal(out, dilated), "dilation differs from the reference: " + name);
+                erode(bit_grid, out, elements[e], radius);
+                check(equal(out, eroded), "erosion differs from the reference: " + name);
+
+                // opening and closing in place, as OccupancyGrid does
+                out = bit_grid;
+                erode(out, out, elements[e], radius);
+                dilate(out, out, elements[e], radius);
+                check(equal(out, reference_morphology(eroded, elements[e], radius, true)), "opening differs from the reference: " + name);
+                out = bit_grid;
+                dilate(out, out, elements[e], radius);
+                erode(out, out, elements[e], radius);
+                check(equal(out, reference_morphology(dilated, elements[e], radius, false)), "closing differs from the reference: " + name);
+            }
+    }
+
+    // CSG of two overlapping balls: the combined SDF voxel by voxel, and its
+    // bit grid against the bitwise operation of the bit grids of the balls
+    const Eigen::Vector3i number_of_bins(70, 41, 37);
+    const double grid_size = 0.05;
+    SDF a = make_ball(0.6, Eigen::Vector3d(0.4, 0, -0.1), number_of_bins, grid_size);
+    SDF b = make_ball(0.5, Eigen::Vector3d(1.01, 0.02, -0.1), number_of_bins, grid_size);
+    const BitGrid bits_a = a.get_bit_grid(), bits_b = b.get_bit_grid();
+    const char * operation_names[] = {"union", "intersection", "difference"};
+    const CSGOperation operations[] = {CSG_UNION, CSG_INTERSECTION, CSG_DIFFERENCE};
+
+    for (int o = 0; o < 3; ++o) {
+        SDF combined = a.combine(b, operations[o]);
+        const Eigen::Tensor<double, 3> & values = combined.get_SDF();
+        check(values.dimension(0) == number_of_bins(0) && values.dimension(1) == number_of_bins(1) && values.dimension(2) == number_of_bins(2),
+              std::string(operation_names[o]) + ": wrong grid dimensions");
+        if (values.size() != a.get_SDF().size())
+            continue;
+
+        long int wrong = 0;
+        for (long int i = 0; i < values.size(); ++i) {
+            const double value_a = a.get_SDF().data()[i], value_b = b.get_SDF().data()[i];
+            double expected = o == 0 ? std::max(value_a, value_b) : (o == 1 ? std::min(value_a, value_b) : std::min(value_a, -value_b));
+            if (values.data()[i] != expected)
+                wrong++;
+        }
+        check(wrong == 0, std::string(operation_names[o]) + ": " + std::to_string(wrong) + " voxels differ from the reference");
+
+        BitGrid expected_bits(number_of_bins(0), number_of_bins(1), number_of_bins(2));
+        for (int z = 0; z < number_of_bins(2); ++z)
+            for (int y = 0; y < number_of_bins(1); ++y)
+                for (int w = 0; w < expected_bits.get_words_per_row(); ++w) {
+                    const uint64_t word_a = bits_a.row(y, z)[w], word_b = bits_b.row(y, z)[w];
+                    expected_bits.row(y, z)[w] = o == 0 ? word_a | word_b : (o == 1 ? word_a & word_b : word_a & ~word_b);
+                }
+        Eigen::Tensor<bool, 3> expected;
+        expected_bits.to_tensor(expected);
+        check(equal(combined.get_bit_grid(), expected), std::string(operation_names[o]) + ": bit grid differs from the bitwise operation");
+    }
+
+    if (failures == 0)
+        std::cout << "Progress: all the bit grid checks passed\n";
+    return failures == 0 ? 0 : 1;
+}
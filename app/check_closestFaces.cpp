@@ -0,0 +1,86 @@
+#include <iostream>
+#include <cmath>
+#include <limits>
+#include <Eigen/Core>
+#include <unsupported/Eigen/CXX11/Tensor>
+
+#include "mesh/sampleSurface.h"
+#include "mesh/closestPointOnTriangle.h"
+#include "sdf.h"
+
+// latitude-longitude sphere, with faces of uneven sizes
+void make_uv_sphere(double radius, int rings, int sectors, Eigen::MatrixXd & V, Eigen::MatrixXi & F) {
+    V.resize(3, (rings - 1) * sectors + 2);
+    V.col(0) << 0, 0, radius;
+    V.col(V.cols() - 1) << 0, 0, -radius;
+    for (int r = 1; r < rings; ++r)
+        for (int s = 0; s < sectors; ++s) {
+            const double theta = M_PI * r / rings, phi = 2 * M_PI * s / sectors;
+            V.col(1 + (r - 1) * sectors + s) << radius * std::sin(theta) * std::cos(phi), radius * std::sin(theta) * std::sin(phi), radius * std::cos(theta);
+        }
+
+    std::vector< Eigen::Vector3i > faces;
+    for (int s = 0; s < sectors; ++s) {
+        const int next = (s + 1) % sectors;
+        faces.push_back(Eigen::Vector3i(0, 1 + s, 1 + next));
+        faces.push_back(Eigen::Vector3i(V.cols() - 1, 1 + (rings - 2) * sectors + next, 1 + (rings - 2) * sectors + s));
+        for (int r = 1; r < rings - 1; ++r) {
+            const int a = 1 + (r - 1) * sectors + s, b = 1 + (r - 1) * sectors + next;
+            faces.push_back(Eigen::Vector3i(a, a + sectors, b + sectors));
+            faces.push_back(Eigen::Vector3i(a, b + sectors, b));
+        }
+    }
+    F.resize(3, faces.size());
+    for (int i = 0; i < faces.size(); ++i)
+        F.col(i) = faces[i];
+};
+
+// distance from p to the projection given by a face and barycentric coordinates
+double projection_distance(const Eigen::Vector3d & p, const Eigen::MatrixXd & V, const Eigen::MatrixXi & F, int face, const Eigen::Vector3d & weights) {
+    return (weights(0) * V.col(F(0, face)) + weights(1) * V.col(F(1, face)) + weights(2) * V.col(F(2, face)) - p).norm();
+};
+
+int main() {
+    Eigen::MatrixXd V, samples_V, samples_N, samples_barycentric;
+    Eigen::MatrixXi F;
+    Eigen::VectorXi samples_faces;
+    make_uv_sphere(0.5, 12, 24, V, F);
+    sample_surface(V, F, 0.02, samples_V, samples_N, samples_faces, samples_barycentric);
+
+    SDF sdf(samples_V, samples_N, 24, 1.2, false, true);
+    Eigen::Tensor<int, 3> faces;
+    Eigen::Matrix<float, 3, Eigen::Dynamic> barycentric;
+    if (!sdf.get_closest_faces(V, F, samples_faces, faces, barycentric)) {
+        std::cout << "Error: no closest faces\n";
+        return 1;
+    }
+
+    // brute force closest face of every voxel
+    const double grid_size = sdf.get_grid_size();
+    const Eigen::Vector3d source = sdf.get_source();
+    const Eigen::Matrix3d rotation = sdf.get_rotation();
+    long int wrong = 0;
+    double worst = 0;
+    for (int z = 0; z < faces.dimension(2); ++z)
+        for (int y = 0; y < faces.dimension(1); ++y)
+            for (int x = 0; x < faces.dimension(0); ++x) {
+                const Eigen::Vector3d point = rotation * (Eigen::Vector3d(x, y, z) * grid_size + source);
+                double best = std::numeric_limits<double>::max();
+                for (int f = 0; f < F.cols(); ++f)
+                    best = std::min(best, projection_distance(point, V, F, f, closest_point_on_triangle(point, V.col(F(0, f)), V.col(F(1, f)), V.col(F(2, f)))));
+
+                const long int i = x + y * faces.dimension(0) + z * long(faces.dimension(0)) * faces.dimension(1);
+                const double found = projection_distance(point, V, F, faces(x, y, z), barycentric.col(i).cast<double>());
+                if (found > best + 1e-5) {
+                    wrong++;
+                    worst = std::max(worst, found - best);
+                }
+            }
+
+    if (wrong > 0) {
+        std::cout << "Error: " << wrong << " voxels are not mapped to their closest face, up to " << worst << " further\n";
+        return 1;
+    }
+    std::cout << "Progress: all the closest faces checks passed\n";
+    return 0;
+}
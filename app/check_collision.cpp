@@ -0,0 +1,75 @@
+#include <iostream>
+#include <vector>
+#include <Eigen/Core>
+#include <unsupported/Eigen/CXX11/Tensor>
+
+#include "sdf.h"
+#include "collisionSDF.h"
+
+// analytic SDF of a ball of given radius centered at the origin, sampled on [-1, 1]^3
+SDF make_ball(double radius, int number_of_bins) {
+    const double grid_size = 2.0 / (number_of_bins - 1);
+    const Eigen::Vector3d source = Eigen::Vector3d::Constant(-1);
+    Eigen::Tensor<double, 3> grid(number_of_bins, number_of_bins, number_of_bins);
+    for (int z = 0; z < number_of_bins; ++z)
+        for (int y = 0; y < number_of_bins; ++y)
+            for (int x = 0; x < number_of_bins; ++x)
+                grid(x, y, z) = radius - (Eigen::Vector3d(x, y, z) * grid_size + source).norm();
+    return SDF(grid, grid_size, source);
+};
+
+int failures = 0;
+
+void check(bool condition, std::string description) {
+    if (!condition) {
+        std::cout << "Error: " << description << std::endl;
+        failures++;
+    }
+};
+
+int main() {
+    // the ball goes through the faces of the grid, so the clamped values
+    // on the border are positive
+    SDF sdf = make_ball(1.2, 41);
+
+    // primitives inside the grid and in contact
+    Eigen::MatrixXd centers(3, 2);
+    centers << 0.9, 3.0,
+               0.0, 0.0,
+               0.0, 0.0;
+    Eigen::VectorXd radii = Eigen::VectorXd::Constant(2, 0.5);
+    Eigen::VectorXd penetrations;
+    Eigen::MatrixXd normals;
+
+    collide_spheres(sdf, centers, radii, penetrations, normals);
+    check(std::abs(penetrations(0) - 0.8) < 0.05, "sphere in contact, wrong penetration");
+    check(normals.col(0).isApprox(Eigen::Vector3d(1, 0, 0), 0.05), "sphere in contact, wrong normal");
+
+    // primitives outside the grid: the clamped lookup would report a contact
+    check(penetrations(1) <= 0, "sphere outside the grid reported in contact");
+    check(penetrations(1) < -1.2, "sphere outside the grid, clearance bound too loose");
+    check(normals.col(1).isZero(), "sphere outside the grid has a normal");
+
+    Eigen::MatrixXd first_points(3, 2), second_points(3, 2);
+    first_points << 0.5, 3.0,
+                    0.0, -0.5,
+                    0.0, 0.0;
+    second_points << 1.5, 3.0,
+                     0.0, 0.5,
+                     0.0, 0.0;
+    radii.setConstant(0.1);
+    collide_capsules(sdf, first_points, second_points, radii, penetrations, normals);
+    check(penetrations(0) > 0, "capsule through the ball not in contact");
+    check(penetrations(1) <= 0, "capsule outside the grid reported in contact");
+
+    std::vector< Eigen::Matrix3d > rotations(2, Eigen::Matrix3d::Identity());
+    Eigen::MatrixXd half_extents = Eigen::MatrixXd::Constant(3, 2, 0.25);
+    centers.col(1) << 0.0, 2.5, 0.0;
+    collide_boxes(sdf, centers, rotations, half_extents, penetrations, normals);
+    check(penetrations(0) > 0, "box in the ball not in contact");
+    check(penetrations(1) <= 0, "box outside the grid reported in contact");
+
+    if (failures == 0)
+        std::cout << "Progress: all the collision checks passed\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+#include <iostream>
+#include <cmath>
+#include <map>
+#include <utility>
+#include <Eigen/Core>
+
+#include "mesh/decimateMesh.h"
+
+// latitude-longitude sphere, a closed mesh
+void make_uv_sphere(double radius, int rings, int sectors, Eigen::MatrixXd & V, Eigen::MatrixXi & F) {
+    V.resize(3, (rings - 1) * sectors + 2);
+    V.col(0) << 0, 0, radius;
+    V.col(V.cols() - 1) << 0, 0, -radius;
+    for (int r = 1; r < rings; ++r)
+        for (int s = 0; s < sectors; ++s) {
+            const double theta = M_PI * r / rings, phi = 2 * M_PI * s / sectors;
+            V.col(1 + (r - 1) * sectors + s) << radius * std::sin(theta) * std::cos(phi), radius * std::sin(theta) * std::sin(phi), radius * std::cos(theta);
+        }
+
+    std::vector< Eigen::Vector3i > faces;
+    for (int s = 0; s < sectors; ++s) {
+        const int next = (s + 1) % sectors;
+        faces.push_back(Eigen::Vector3i(0, 1 + s, 1 + next));
+        faces.push_back(Eigen::Vector3i(V.cols() - 1, 1 + (rings - 2) * sectors + next, 1 + (rings - 2) * sectors + s));
+        for (int r = 1; r < rings - 1; ++r) {
+            const int a = 1 + (r - 1) * sectors + s, b = 1 + (r - 1) * sectors + next;
+            faces.push_back(Eigen::Vector3i(a, a + sectors, b + sectors));
+            faces.push_back(Eigen::Vector3i(a, b + sectors, b));
+        }
+    }
+    F.resize(3, faces.size());
+    for (int i = 0; i < faces.size(); ++i)
+        F.col(i) = faces[i];
+};
+
+// number of edges shared by an odd number of faces, i.e. the borders of holes
+int count_open_edges(const Eigen::MatrixXi & F) {
+    std::map< std::pair<int, int>, int > edges;
+    for (int i = 0; i < F.cols(); ++i)
+        for (int k = 0; k < 3; ++k) {
+            const int a = F(k, i), b = F((k + 1) % 3, i);
+            edges[std::make_pair(std::min(a, b), std::max(a, b))]++;
+        }
+    int open_edges = 0;
+    for (std::map< std::pair<int, int>, int >::iterator it = edges.begin(); it != edges.end(); ++it)
+        open_edges += it->second % 2;
+    return open_edges;
+};
+
+int failures = 0;
+
+void check(bool condition, std::string description) {
+    if (!condition) {
+        std::cout << "Error: " << description << std::endl;
+        failures++;
+    }
+};
+
+int main() {
+    Eigen::MatrixXd V, V_out;
+    Eigen::MatrixXi F, F_out;
+    make_uv_sphere(0.5, 80, 160, V, F);
+    V += 0.002 * Eigen::MatrixXd::Random(3, V.cols());     // noise, so that some faces fold over
+    check(count_open_edges(F) == 0, "the input sphere is not closed");
+
+    // a closed mesh stays closed
+    const double edge_lengths[3] = {0.02, 0.05, 0.12};
+    for (int i = 0; i < 3; ++i) {
+        decimate_mesh(V, F, edge_lengths[i], V_out, F_out);
+        check(F_out.cols() > 0 && F_out.cols() < F.cols(), "decimation to " + std::to_string(edge_lengths[i]) + " did not reduce the mesh");
+        check(count_open_edges(F_out) == 0, "decimation to " + std::to_string(edge_lengths[i]) + " opened holes");
+    }
+
+    // cells too small for 64 bits keys: the mesh is returned unchanged
+    decimate_mesh(V, F, 1e-8, V_out, F_out);
+    check(V_out == V && F_out == F, "decimation with too many cells changed the mesh");
+
+    // more than 2^21 cells along one axis, which fits with the bits left by the
+    // other axes: every vertex is alone in its cell and the mesh is unchanged
+    Eigen::MatrixXd V_long = V;
+    V_long.row(0) *= 100;
+    decimate_mesh(V_long, F, 1e-5, V_out, F_out);
+    check(V_out.cols() == V.cols() && F_out.cols() == F.cols(), "decimation of an elongated mesh into 2^24 cells along x merged cells");
+
+    if (failures == 0)
+        std::cout << "Progress: all the decimation checks passed\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+#include <iostream>
+#include <cmath>
+#include <Eigen/Core>
+#include <unsupported/Eigen/CXX11/Tensor>
+
+#include "sdf.h"
+#include "occupancyGrid.h"
+#include "gridPyramid.h"
+
+// analytic SDF of a ball of given radius centered at the origin, sampled on [-1, 1]^3
+SDF make_ball(double radius, int number_of_bins) {
+    const double grid_size = 2.0 / (number_of_bins - 1);
+    const Eigen::Vector3d source = Eigen::Vector3d::Constant(-1);
+    Eigen::Tensor<double, 3> grid(number_of_bins, number_of_bins, number_of_bins);
+    for (int z = 0; z < number_of_bins; ++z)
+        for (int y = 0; y < number_of_bins; ++y)
+            for (int x = 0; x < number_of_bins; ++x)
+                grid(x, y, z) = radius - (Eigen::Vector3d(x, y, z) * grid_size + source).norm();
+    return SDF(grid, grid_size, source);
+};
+
+// points and outward normals on a sphere (Fibonacci lattice)
+void make_sphere(double radius, int number_of_points, Eigen::MatrixXd & V, Eigen::MatrixXd & N) {
+    V.resize(3, number_of_points);
+    N.resize(3, number_of_points);
+    const double golden_angle = M_PI * (3 - std::sqrt(5.0));
+    for (int i = 0; i < number_of_points; ++i) {
+        const double z = 1 - 2 * (i + 0.5) / number_of_points;
+        const double r = std::sqrt(1 - z * z);
+        N.col(i) << r * std::cos(golden_angle * i), r * std::sin(golden_angle * i), z;
+        V.col(i) = radius * N.col(i);
+    }
+};
+
+int failures = 0;
+
+void check(bool condition, std::string description) {
+    if (!condition) {
+        std::cout << "Error: " << description << std::endl;
+        failures++;
+    }
+};
+
+int main() {
+    // voxel ranges of boxes smaller than a voxel, the voxels are centered on the samples
+    const Eigen::Vector3d source = Eigen::Vector3d::Zero();
+    const Eigen::Matrix3d rotation = Eigen::Matrix3d::Identity();
+    const Eigen::Vector3i number_of_bins(10, 10, 10);
+    Eigen::Vector3i first, last;
+
+    check(box_to_voxel_range(Eigen::Vector3d::Constant(2.1), Eigen::Vector3d::Constant(2.3), source, rotation, 1.0, number_of_bins, first, last),
+          "sub-voxel box inside a voxel has an empty range");
+    check(first == Eigen::Vector3i::Constant(2) && last == Eigen::Vector3i::Constant(2), "sub-voxel box inside a voxel, wrong range");
+
+    check(box_to_voxel_range(Eigen::Vector3d::Constant(2.4), Eigen::Vector3d::Constant(2.6), source, rotation, 1.0, number_of_bins, first, last),
+          "sub-voxel box across two voxels has an empty range");
+    check(first == Eigen::Vector3i::Constant(2) && last == Eigen::Vector3i::Constant(3), "sub-voxel box across two voxels, wrong range");
+
+    check(box_to_voxel_range(Eigen::Vector3d::Constant(-0.4), Eigen::Vector3d::Constant(-0.2), source, rotation, 1.0, number_of_bins, first, last),
+          "sub-voxel box on the border voxel has an empty range");
+    check(!box_to_voxel_range(Eigen::Vector3d::Constant(-0.8), Eigen::Vector3d::Constant(-0.6), source, rotation, 1.0, number_of_bins, first, last),
+          "box outside the grid has a non empty range");
+
+    // tiny boxes on the surface of a ball and deep inside it are not free, one
+    // away from it is, and so is a large box around the ball but not a box
+    // beyond the grid
+    SDF sdf = make_ball(0.5, 41);
+    SDFPyramid sdf_pyramid(sdf);
+    const Eigen::Vector3d tiny = Eigen::Vector3d::Constant(0.001);
+    const Eigen::Vector3d on_surface(0.5, 0.01, 0.01);
+    const Eigen::Vector3d away(0.8, 0.8, 0.01);
+    check(!sdf_pyramid.is_free(on_surface - tiny, on_surface + tiny, 0.1), "sub-voxel box on the surface reported free");
+    check(!sdf_pyramid.is_free(-tiny, tiny, 0.1), "sub-voxel box at the center reported free");
+    check(sdf_pyramid.is_free(away - tiny, away + tiny, 0.1), "sub-voxel box away from the ball reported not free");
+    check(sdf_pyramid.is_free(Eigen::Vector3d(0.7, -1, -1), Eigen::Vector3d(1, 1, 1), 0.1), "slab away from the ball reported not free");
+    check(!sdf_pyramid.is_free(Eigen::Vector3d(0.3, -1, -1), Eigen::Vector3d(1, 1, 1), 0.1), "slab through the ball reported free");
+    check(!sdf_pyramid.is_free(Eigen::Vector3d::Constant(2), Eigen::Vector3d::Constant(3), 0.1), "box outside the grid reported free");
+
+    // a tiny box at the center of a ball is occupied, one outside it is not
+    Eigen::MatrixXd V, N;
+    make_sphere(0.5, 20000, V, N);
+    OccupancyGrid occupancy_grid(V, N, 20, 1.2);
+    OccupancyPyramid occupancy_pyramid(occupancy_grid);
+    const Eigen::Vector3d outside(0.55, 0.55, 0.55);
+    check(occupancy_pyramid.is_occupied(-tiny, tiny), "sub-voxel box at the center reported free");
+    check(!occupancy_pyramid.is_occupied(outside - tiny, outside + tiny), "sub-voxel box outside the ball reported occupied");
+
+    if (failures == 0)
+        std::cout << "Progress: all the grid pyramid checks passed\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,69 @@
+#include <iostream>
+#include <cmath>
+#include <Eigen/Core>
+#include <unsupported/Eigen/CXX11/Tensor>
+
+#include "occupancyGrid.h"
+
+// points and outward normals on a sphere (Fibonacci lattice)
+void make_sphere(double radius, int number_of_points, Eigen::MatrixXd & V, Eigen::MatrixXd & N) {
+    V.resize(3, number_of_points);
+    N.resize(3, number_of_points);
+    const double golden_angle = M_PI * (3 - std::sqrt(5.0));
+    for (int i = 0; i < number_of_points; ++i) {
+        const double z = 1 - 2 * (i + 0.5) / number_of_points;
+        const double r = std::sqrt(1 - z * z);
+        N.col(i) << r * std::cos(golden_angle * i), r * std::sin(golden_angle * i), z;
+        V.col(i) = radius * N.col(i);
+    }
+};
+
+// occupancy of the voxel holding a world-space point
+bool occupied_at(OccupancyGrid & occupancy_grid, const Eigen::Vector3d & point) {
+    const Eigen::Tensor<bool, 3> & grid = occupancy_grid.get_occupancy_grid();
+    Eigen::Vector3d local = (occupancy_grid.get_rotation().transpose() * point - occupancy_grid.get_source()) / occupancy_grid.get_grid_size();
+    return grid(int(std::round(local(0))), int(std::round(local(1))), int(std::round(local(2))));
+};
+
+int failures = 0;
+
+void check(bool condition, std::string description) {
+    if (!condition) {
+        std::cout << "Error: " << description << std::endl;
+        failures++;
+    }
+};
+
+int main() {
+    const double radius = 0.5;
+    const Eigen::Vector3d center = Eigen::Vector3d::Zero();
+    const Eigen::Vector3d outside(0.45, 0.45, 0.45);
+
+    // dense points, the whole grid
+    Eigen::MatrixXd V, N;
+    make_sphere(radius, 20000, V, N);
+    OccupancyGrid dense(V, N, 40, 1.2, false, true);
+    check(occupied_at(dense, center), "flood fill, the center of the ball is not occupied");
+    check(!occupied_at(dense, outside), "flood fill, a corner of the grid is occupied");
+
+    // points sparser than the voxels: the shell must not leak
+    make_sphere(radius, 500, V, N);
+    OccupancyGrid sparse(V, N, 60, 1.2, false, true);
+    check(occupied_at(sparse, center), "flood fill with sparse points, the center of the ball is not occupied");
+    check(!occupied_at(sparse, outside), "flood fill with sparse points, a corner of the grid is occupied");
+
+    // roi cutting through the ball: its -x face is not exterior
+    make_sphere(radius, 20000, V, N);
+    OccupancyGrid roi(V, N, Eigen::Vector3d(0, -0.6, -0.6), Eigen::Vector3d(0.6, 0.6, 0.6), 0.025, true);
+    check(occupied_at(roi, Eigen::Vector3d(0, 0, 0)), "flood fill in a roi, the cut face of the ball is not occupied");
+    check(occupied_at(roi, Eigen::Vector3d(0.25, 0, 0)), "flood fill in a roi, the inside of the ball is not occupied");
+    check(!occupied_at(roi, outside), "flood fill in a roi, a corner of the roi is occupied");
+
+    // roi inside the points: no exterior face, the normals are used
+    OccupancyGrid inner(V, N, Eigen::Vector3d(-0.2, -0.2, -0.2), Eigen::Vector3d(0.2, 0.2, 0.2), 0.025, true);
+    check(occupied_at(inner, center), "roi inside the ball, the center is not occupied");
+
+    if (failures == 0)
+        std::cout << "Progress: all the occupancy grid checks passed\n";
+    return failures == 0 ? 0 : 1;
+}
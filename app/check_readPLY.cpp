@@ -0,0 +1,112 @@
+#include <iostream>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <Eigen/Core>
+
+#include "IO/readPLY.h"
+#include "IO/writePLY.h"
+
+int failures = 0;
+
+void check(bool condition, std::string description) {
+    if (!condition) {
+        std::cout << "Error: " << description << std::endl;
+        failures++;
+    }
+};
+
+// write a mesh and read it back
+void round_trip(std::string name, Eigen::MatrixXd & V, Eigen::MatrixXi & F, Eigen::MatrixXd & N, Eigen::MatrixXi & RGB, bool ascii) {
+    const std::string filepath = "check_readPLY_" + name + ".ply";
+    writePLY(filepath, V, F, N, RGB, ascii);
+
+    Eigen::MatrixXd V_in, N_in;
+    Eigen::MatrixXi F_in, RGB_in;
+    readPLY(filepath, V_in, F_in, N_in, RGB_in);
+    std::remove(filepath.c_str());
+
+    // float precision, and the 6 significant digits of the ascii writer
+    const double tolerance = ascii ? 1e-5 : 1e-7;
+    check(V_in.cols() == V.cols() && (V_in - V).cwiseAbs().maxCoeff() < tolerance, name + ": wrong vertices");
+    check(F_in == F, name + ": wrong faces");
+    if (N.cols() == V.cols())
+        check(N_in.cols() == N.cols() && (N_in - N).cwiseAbs().maxCoeff() < tolerance, name + ": wrong normals");
+    if (RGB.cols() == V.cols())
+        check(RGB_in == RGB, name + ": wrong colors");
+};
+
+// write the positions and normals as binary records of 24 bytes, with a
+// header padded so that the body starts on a 4 bytes boundary, and view them
+void zero_copy_views(const Eigen::MatrixXd & V, const Eigen::MatrixXd & N) {
+    const std::string filepath = "check_readPLY_views.ply";
+    std::string header = "ply\nformat binary_little_endian 1.0\nelement vertex " + std::to_string(V.cols()) +
+                         "\nproperty float x\nproperty float y\nproperty float z\nproperty float nx\nproperty float ny\nproperty float nz\ncomment ";
+    while ((header.size() + std::string("\nend_header\n").size()) % 4 != 0)
+        header += "_";
+    header += "\nend_header\n";
+
+    std::ofstream file(filepath.c_str(), std::ios::binary);
+    file.write(header.data(), header.size());
+    for (int i = 0; i < V.cols(); ++i) {
+        float record[6] = {float(V(0, i)), float(V(1, i)), float(V(2, i)), float(N(0, i)), float(N(1, i)), float(N(2, i))};
+        file.write(reinterpret_cast<const char *>(record), sizeof(record));
+    }
+    file.close();
+
+    {
+        MappedPLY mapped_ply(filepath);
+        check(mapped_ply.has_vertex_views() && mapped_ply.has_normal_views(), "views: float aligned records are not viewed");
+        if (mapped_ply.has_vertex_views() && mapped_ply.has_normal_views()) {
+            check(mapped_ply.vertices().isApprox(V.cast<float>()), "views: wrong vertices");
+            check(mapped_ply.normals().isApprox(N.cast<float>()), "views: wrong normals");
+        }
+    }
+    std::remove(filepath.c_str());
+};
+
+// ascii faces with an extra property are not handled by the parallel parser,
+// the file must still be read through tinyply
+void ascii_fallback() {
+    const std::string filepath = "check_readPLY_fallback.ply";
+    std::ofstream file(filepath.c_str());
+    file << "ply\nformat ascii 1.0\nelement vertex 3\nproperty float x\nproperty float y\nproperty float z\n"
+            "element face 1\nproperty list uchar int vertex_indices\nproperty uchar flags\nend_header\n"
+            "0 0 0\n1 0 0\n0 1 0\n3 0 1 2 7\n";
+    file.close();
+
+    Eigen::MatrixXd V, N;
+    Eigen::MatrixXi F, RGB;
+    readPLY(filepath, V, F, N, RGB);
+    std::remove(filepath.c_str());
+
+    Eigen::Matrix3d V_expected;
+    V_expected << 0, 1, 0,
+                  0, 0, 1,
+                  0, 0, 0;
+    check(V.cols() == 3 && V.isApprox(V_expected), "ascii fallback: wrong vertices");
+    check(F.cols() == 1 && F(0, 0) == 0 && F(1, 0) == 1 && F(2, 0) == 2, "ascii fallback: wrong faces");
+};
+
+int main() {
+    const int number_of_vertices = 1001, number_of_faces = 2000;
+    Eigen::MatrixXd V = Eigen::MatrixXd::Random(3, number_of_vertices);
+    Eigen::MatrixXd N = Eigen::MatrixXd::Random(3, number_of_vertices);
+    N.colwise().normalize();
+    Eigen::MatrixXi RGB = (Eigen::MatrixXd::Random(3, number_of_vertices).array().abs() * 255).cast<int>();
+    Eigen::MatrixXi F = (Eigen::MatrixXd::Random(3, number_of_faces).array().abs() * (number_of_vertices - 1)).cast<int>();
+    Eigen::MatrixXd no_normals;
+    Eigen::MatrixXi no_colors;
+
+    // 12, 24 and 27 bytes vertex records: the last one is not a multiple of 4 bytes
+    round_trip("positions", V, F, no_normals, no_colors, false);
+    round_trip("normals", V, F, N, no_colors, false);
+    round_trip("colors", V, F, N, RGB, false);
+    round_trip("ascii", V, F, N, RGB, true);
+    zero_copy_views(V, N);
+    ascii_fallback();
+
+    if (failures == 0)
+        std::cout << "Progress: all the PLY reading checks passed\n";
+    return failures == 0 ? 0 : 1;
+}
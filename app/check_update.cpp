@@ -0,0 +1,88 @@
+#include <iostream>
+#include <cmath>
+#include <vector>
+#include <Eigen/Core>
+#include <unsupported/Eigen/CXX11/Tensor>
+
+#include "sdf.h"
+#include "occupancyGrid.h"
+
+// points and outward normals on a sphere (Fibonacci lattice)
+void make_sphere(double radius, const Eigen::Vector3d & center, int number_of_points, Eigen::MatrixXd & V, Eigen::MatrixXd & N) {
+    V.resize(3, number_of_points);
+    N.resize(3, number_of_points);
+    const double golden_angle = M_PI * (3 - std::sqrt(5.0));
+    for (int i = 0; i < number_of_points; ++i) {
+        const double z = 1 - 2 * (i + 0.5) / number_of_points;
+        const double r = std::sqrt(1 - z * z);
+        N.col(i) << r * std::cos(golden_angle * i), r * std::sin(golden_angle * i), z;
+        V.col(i) = radius * N.col(i) + center;
+    }
+};
+
+int failures = 0;
+
+void check(bool condition, std::string description) {
+    if (!condition) {
+        std::cout << "Error: " << description << std::endl;
+        failures++;
+    }
+};
+
+int main() {
+    const Eigen::Vector3d roi_min = Eigen::Vector3d::Constant(-1), roi_max = Eigen::Vector3d::Constant(1);
+    const double leaf_size = 0.05;
+
+    // two balls, the second one is removed and a third one is added
+    Eigen::MatrixXd V_first, N_first, V_second, N_second, V_added, N_added;
+    make_sphere(0.3, Eigen::Vector3d(-0.4, 0, 0), 2000, V_first, N_first);
+    make_sphere(0.3, Eigen::Vector3d(0.4, 0, 0), 2000, V_second, N_second);
+    make_sphere(0.2, Eigen::Vector3d(0, 0.6, 0), 1000, V_added, N_added);
+
+    Eigen::MatrixXd V(3, 4000), N(3, 4000);
+    V << V_first, V_second;
+    N << N_first, N_second;
+    std::vector<int> removed;
+    for (int i = 2000; i < 4000; ++i)
+        removed.push_back(i);
+
+    // incremental update against a full rebuild from the final points
+    Eigen::MatrixXd V_final(3, 3000), N_final(3, 3000);
+    V_final << V_first, V_added;
+    N_final << N_first, N_added;
+
+    SDF sdf(V, N, roi_min, roi_max, leaf_size);
+    check(sdf.update(removed, V_added, N_added) > 0, "SDF update, no brick recomputed");
+    SDF sdf_rebuilt(V_final, N_final, roi_min, roi_max, leaf_size);
+    Eigen::Tensor<double, 0> sdf_difference = (sdf.get_SDF() - sdf_rebuilt.get_SDF()).abs().maximum();
+    check(sdf_difference() < 1e-12, "SDF update differs from a rebuild");
+
+    OccupancyGrid occupancy_grid(V, N, roi_min, roi_max, leaf_size);
+    check(occupancy_grid.update(removed, V_added, N_added) > 0, "occupancy grid update, no brick recomputed");
+    OccupancyGrid occupancy_grid_rebuilt(V_final, N_final, roi_min, roi_max, leaf_size);
+    Eigen::Tensor<bool, 0> occupancy_equal = (occupancy_grid.get_occupancy_grid() == occupancy_grid_rebuilt.get_occupancy_grid()).all();
+    check(occupancy_equal(), "occupancy grid update differs from a rebuild");
+
+    // invalid edits are rejected and leave the grids unchanged
+    Eigen::MatrixXd one_normal = N_added.leftCols(1);
+    std::vector<int> out_of_range(1, 3000), repeated(2, 0), none;
+    Eigen::Tensor<double, 3> before = sdf.get_SDF();
+    check(sdf.update(none, V_added, one_normal) == -1, "SDF update accepted points without normals");
+    check(sdf.update(out_of_range, Eigen::MatrixXd(), Eigen::MatrixXd()) == -1, "SDF update accepted an out of range index");
+    check(sdf.update(repeated, Eigen::MatrixXd(), Eigen::MatrixXd()) == -1, "SDF update accepted a repeated index");
+    Eigen::Tensor<double, 0> unchanged = (sdf.get_SDF() - before).abs().maximum();
+    check(unchanged() == 0, "rejected SDF updates changed the grid");
+
+    check(occupancy_grid.update(none, V_added, one_normal) == -1, "occupancy grid update accepted points without normals");
+    check(occupancy_grid.update(out_of_range, Eigen::MatrixXd(), Eigen::MatrixXd()) == -1, "occupancy grid update accepted an out of range index");
+
+    // grids which are not built from points cannot be updated
+    SDF wrapped(sdf.get_SDF(), leaf_size, roi_min);
+    check(wrapped.update(none, V_added, N_added) == -1, "update of a wrapped grid accepted");
+    SDF volume(roi_min, roi_max, leaf_size);
+    check(volume.update(none, V_added, N_added) == -1, "update of a depth volume accepted");
+
+    if (failures == 0)
+        std::cout << "Progress: all the update checks passed\n";
+    return failures == 0 ? 0 : 1;
+}
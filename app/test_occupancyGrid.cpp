@@ -10,31 +10,38 @@
 
 #include "mesh/computeNormals.h"
 #include "mesh/computeFacesCentroids.h"
+#include "mesh/sampleSurface.h"
+#include "mesh/decimateMesh.h"
 #include "occupancyGrid.h"
 
 int main() {
     bool visualization = true;
     int grid_resolution = 100;          // grid_resolution is used to define the grid resolution in the maximum direction
     double bounding_box_scale = 1;
+    bool decimation = false;            // collapse the triangles much smaller than a voxel before sampling
 
     // IO: load files
     std::cout << "Progress: load data\n";
-    Eigen::MatrixXd V, cubes_V, faces_V;
+    Eigen::MatrixXd V, cubes_V, samples_V;
     Eigen::MatrixXi F, cubes_F;
-    Eigen::MatrixXd N, faces_N;
+    Eigen::MatrixXd N, samples_N;
     Eigen::MatrixXi RGB;
 
     readPLY("../data/Lucy100k.ply", V, F, N, RGB);
 
     std::cout << "size of V: " << V.rows() << ", " << V.cols() << "\n";
 
-    faces_V = compute_faces_centroids(V,F);
-    faces_N = compute_faces_normals(V,F);
+    // sample the surface with a density tied to the voxel size rather than to the tessellation
+    double leaf_size = getLeafSize(V, grid_resolution, bounding_box_scale);
+    if (decimation)
+        decimate_mesh(V, F, leaf_size/2, V, F);
+
+    sample_surface(V, F, leaf_size/2, samples_V, samples_N);
 
     if (visualization)
         plot_mesh(V,F);
 
-    OccupancyGrid occupancy_grid(faces_V, faces_N, grid_resolution, bounding_box_scale);
+    OccupancyGrid occupancy_grid(samples_V, samples_N, grid_resolution, bounding_box_scale);
     
     Eigen::MatrixXd graph_V;
     Eigen::MatrixXi graph_E;
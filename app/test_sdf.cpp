@@ -10,35 +10,52 @@
 
 #include "mesh/computeNormals.h"
 #include "mesh/computeFacesCentroids.h"
+#include "mesh/sampleSurface.h"
+#include "mesh/decimateMesh.h"
 #include "sdf.h"
+#include "renderSDF.h"
+#include "medialAxis.h"
 
 int main() {
     bool visualization = true;
     int grid_resolution = 100;
     double bounding_box_scale = 1;
+    bool decimation = false;            // collapse the triangles much smaller than a voxel before sampling
 
     // IO: load files
     std::cout << "Progress: load data\n";
-    Eigen::MatrixXd V, faces_V;
+    Eigen::MatrixXd V, samples_V;
     Eigen::MatrixXi F;
-    Eigen::MatrixXd N, faces_N;
+    Eigen::MatrixXd N, samples_N;
     Eigen::MatrixXi RGB;
 
     readPLY("../data/Lucy100k.ply", V, F, N, RGB);
 
-    faces_V = compute_faces_centroids(V,F);
-    faces_N = compute_faces_normals(V,F);
+    // sample the surface with a density tied to the voxel size rather than to the tessellation
+    double leaf_size = getLeafSize(V, grid_resolution, bounding_box_scale);
+    if (decimation)
+        decimate_mesh(V, F, leaf_size/2, V, F);
+
+    sample_surface(V, F, leaf_size/2, samples_V, samples_N);
 
     if (visualization)
         plot_mesh(V,F);
 
     // grid_resolution is used to define the number of grids
 
-    SDF sdf(faces_V, faces_N, grid_resolution, bounding_box_scale);
+    SDF sdf(samples_V, samples_N, grid_resolution, bounding_box_scale);
     
     Eigen::MatrixXd graph_V;
     Eigen::MatrixXi graph_E;
     sdf.generate_graph(graph_V, graph_E);
+
+    Eigen::MatrixXd skeleton_V;
+    Eigen::MatrixXi skeleton_E;
+    Eigen::VectorXd skeleton_radii;
+    extract_medial_axis(sdf, skeleton_V, skeleton_E, skeleton_radii);
+    std::cout << "Progress: skeleton with " << skeleton_V.cols() << " nodes\n";
+
     sdf.print_to_folder("../data/sdf/");
+    render_SDF_to_png(sdf, "../data/sdf_preview.png");
 
 }
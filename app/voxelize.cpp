@@ -0,0 +1,351 @@
+// headless voxelizer: no polyscope, so it has to provide the stb implementation for writePNG
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <sys/stat.h>
+#include <Eigen/Core>
+#include <unsupported/Eigen/CXX11/Tensor>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "IO/readPLY.h"
+
+#include "mesh/computeNormals.h"
+#include "mesh/computeFacesCentroids.h"
+#include "mesh/sampleSurface.h"
+#include "mesh/decimateMesh.h"
+#include "mesh/estimateNormals.h"
+#include "occupancyGrid.h"
+#include "occupancyGridWithColor.h"
+#include "sdf.h"
+#include "renderSDF.h"
+#include "gridStatistics.h"
+#include "batchPipeline.h"
+
+struct Options
+{
+    std::string input;
+    std::string output;                 // prefix of the output files, the input without extension by default (a folder in batch mode)
+    bool output_given;
+    std::string mode;
+    std::vector< std::string > formats;
+    int grid_resolution;
+    double bounding_box_scale;
+    int threads;                        // 0 keeps the OpenMP default (OMP_NUM_THREADS)
+    int normals_neighbours;             // k of the normal estimation for point clouds without normals
+    int io_threads;                     // load and write threads of the batch mode
+    int queue_size;                     // files waiting between two stages of the batch mode
+    bool oriented_bounding_box;
+    bool flood_fill;
+    bool decimation;
+};
+
+inline void print_usage() {
+    std::cout << "Usage: voxelize --input <file.ply or folder> [options]\n"
+              << "  --output <prefix>        prefix of the output files (default: the input without extension, plus _voxels),\n"
+              << "                           or output folder when the input is a folder (default: <folder>_voxelized)\n"
+              << "  --resolution <n>         number of voxels along the largest side (default: 100)\n"
+              << "  --scale <s>              bounding box scale (default: 1)\n"
+              << "  --mode <mode>            occupancy, color or sdf (default: occupancy)\n"
+              << "  --formats <list>         comma separated outputs among ply, yaml, slices, png, stats\n"
+              << "                           (default: ply for occupancy and color, png for sdf)\n"
+              << "  --threads <n>            number of threads (default: OMP_NUM_THREADS)\n"
+              << "  --normals <k>            neighbours used to estimate the normals of a point cloud (default: 12)\n"
+              << "  --oriented               align the grid with the principal axes\n"
+              << "  --flood-fill             occupancy from an exterior flood fill rather than from the normals\n"
+              << "  --decimate               collapse the triangles much smaller than a voxel before sampling\n"
+              << "  --io-threads <n>         load and write threads when the input is a folder (default: 2)\n"
+              << "  --queue <n>              files waiting between two stages when the input is a folder (default: 2)\n";
+};
+
+inline std::vector< std::string > split(const std::string & list, char separator) {
+    std::vector< std::string > items;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, separator))
+        if (!item.empty())
+            items.push_back(item);
+    return items;
+};
+
+// path without its extension, the dot being searched in the file name only
+inline std::string path_stem(const std::string & path) {
+    const size_t slash = path.find_last_of('/');
+    const size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return path;
+    return path.substr(0, dot);
+};
+
+// true when both paths exist and are the same file (whatever the spelling of the paths)
+inline bool is_same_file(const std::string & first, const std::string & second) {
+    struct stat first_stat, second_stat;
+    if (stat(first.c_str(), &first_stat) != 0 || stat(second.c_str(), &second_stat) != 0)
+        return false;
+    return first_stat.st_dev == second_stat.st_dev && first_stat.st_ino == second_stat.st_ino;
+};
+
+inline bool parse_options(int argc, char ** argv, Options & options) {
+    options.mode = "occupancy";
+    options.grid_resolution = 100;
+    options.bounding_box_scale = 1;
+    options.threads = 0;
+    options.normals_neighbours = 12;
+    options.io_threads = 2;
+    options.queue_size = 2;
+    options.oriented_bounding_box = false;
+    options.flood_fill = false;
+    options.decimation = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string flag = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (flag == "--help" || flag == "-h")
+            return false;
+        else if (flag == "--oriented")
+            options.oriented_bounding_box = true;
+        else if (flag == "--flood-fill")
+            options.flood_fill = true;
+        else if (flag == "--decimate")
+            options.decimation = true;
+        else if (has_value && flag == "--input")
+            options.input = argv[++i];
+        else if (has_value && flag == "--output")
+            options.output = argv[++i];
+        else if (has_value && flag == "--mode")
+            options.mode = argv[++i];
+        else if (has_value && flag == "--formats")
+            options.formats = split(argv[++i], ',');
+        else if (has_value && flag == "--resolution")
+            options.grid_resolution = std::atoi(argv[++i]);
+        else if (has_value && flag == "--scale")
+            options.bounding_box_scale = std::atof(argv[++i]);
+        else if (has_value && flag == "--threads")
+            options.threads = std::atoi(argv[++i]);
+        else if (has_value && flag == "--normals")
+            options.normals_neighbours = std::atoi(argv[++i]);
+        else if (has_value && flag == "--io-threads")
+            options.io_threads = std::atoi(argv[++i]);
+        else if (has_value && flag == "--queue")
+            options.queue_size = std::atoi(argv[++i]);
+        else {
+            std::cout << "Error: unknown or incomplete option " << flag << "\n";
+            return false;
+        }
+    }
+
+    if (options.input.empty()) {
+        std::cout << "Error: no input file\n";
+        return false;
+    }
+    if (options.mode != "occupancy" && options.mode != "color" && options.mode != "sdf") {
+        std::cout << "Error: unknown mode " << options.mode << "\n";
+        return false;
+    }
+    if (options.grid_resolution <= 0 || options.bounding_box_scale <= 0) {
+        std::cout << "Error: the resolution and the scale must be positive\n";
+        return false;
+    }
+    options.output_given = !options.output.empty();
+    if (options.output.empty())
+        options.output = path_stem(options.input) + "_voxels";
+    if (options.formats.empty())
+        options.formats.push_back(options.mode == "sdf" ? "png" : "ply");
+
+    return true;
+};
+
+inline bool has_format(const Options & options, const std::string & format) {
+    return std::find(options.formats.begin(), options.formats.end(), format) != options.formats.end();
+};
+
+inline void print_statistics(const GridStatistics & statistics) {
+    std::cout << "voxels: " << statistics.number_of_voxels << "\n"
+              << "volume: " << statistics.volume << "\n"
+              << "surface area: " << statistics.surface_area << "\n"
+              << "centroid: " << statistics.centroid.transpose() << "\n"
+              << "inertia:\n" << statistics.inertia << "\n"
+              << "extents: " << (statistics.box_max - statistics.box_min).transpose() << "\n";
+};
+
+// one input file going through load, compute and write
+struct Job
+{
+    std::string input, output;
+    Eigen::MatrixXd V, N;
+    Eigen::MatrixXi F, RGB;
+    std::shared_ptr<OccupancyGrid> occupancy_grid;
+    std::shared_ptr<OccupancyGridWithColor> color_grid;
+    std::shared_ptr<SDF> sdf;
+};
+
+inline bool load_job(const std::string & input, const std::string & output, Job & job) {
+    job.input = input;
+    job.output = output;
+    readPLY(input, job.V, job.F, job.N, job.RGB);
+    if (job.V.cols() == 0) {
+        std::cout << "Error: no vertices in " << input << "\n";
+        return false;
+    }
+    return true;
+};
+
+inline bool compute_job(const Options & options, Job & job) {
+    Eigen::MatrixXd samples_V, samples_N;
+    double leaf_size = getLeafSize(job.V, options.grid_resolution, options.bounding_box_scale);
+
+    if (options.mode == "color") {
+        if (job.F.cols() == 0 || job.RGB.cols() != job.V.cols()) {
+            std::cout << "Error: the color mode needs a mesh with vertex colors (" << job.input << ")\n";
+            return false;
+        }
+
+        // one colored sample per face
+        Eigen::MatrixXd RGB_double = job.RGB.cast<double> () / 256;
+        Eigen::MatrixXd faces_V = compute_faces_centroids(job.V, job.F);
+        Eigen::MatrixXd faces_N = compute_faces_normals(job.V, job.F);
+        Eigen::MatrixXd faces_RGB = compute_faces_centroids(RGB_double, job.F);
+
+        job.color_grid = std::make_shared<OccupancyGridWithColor>(faces_V, faces_N, faces_RGB, options.grid_resolution, options.bounding_box_scale,
+                                                                  options.oriented_bounding_box);
+        return true;
+    }
+
+    // meshes are sampled with a density tied to the voxel size, point clouds are used as they are
+    if (job.F.cols() > 0) {
+        if (options.decimation)
+            decimate_mesh(job.V, job.F, leaf_size/2, job.V, job.F);
+        sample_surface(job.V, job.F, leaf_size/2, samples_V, samples_N);
+    } else {
+        samples_V = job.V;
+        samples_N = job.N;
+        if (samples_N.cols() != samples_V.cols()) {
+            std::cout << "Progress: estimate the normals\n";
+            estimate_normals(samples_V, options.normals_neighbours, samples_N);
+        }
+    }
+
+    if (options.mode == "occupancy")
+        job.occupancy_grid = std::make_shared<OccupancyGrid>(samples_V, samples_N, options.grid_resolution, options.bounding_box_scale,
+                                                             options.oriented_bounding_box, options.flood_fill);
+    else
+        job.sdf = std::make_shared<SDF>(samples_V, samples_N, options.grid_resolution, options.bounding_box_scale, options.oriented_bounding_box);
+
+    // the input is not needed by the write stage
+    job.V.resize(0, 0);
+    job.N.resize(0, 0);
+    job.F.resize(0, 0);
+    job.RGB.resize(0, 0);
+    return true;
+};
+
+inline bool write_job(const Options & options, Job & job) {
+    static std::mutex statistics_mutex;
+    GridStatistics statistics;
+    const std::string & output = job.output;
+
+    // never overwrite the input
+    const char * extensions[] = {".ply", ".yaml", ".png"};
+    for (int i = 0; i < 3; ++i)
+        if (is_same_file(output + extensions[i], job.input)) {
+            std::cout << "Error: the output " << output + extensions[i] << " is the input file, nothing written\n";
+            return false;
+        }
+
+    if (job.occupancy_grid) {
+        if (has_format(options, "ply"))
+            job.occupancy_grid->write_mesh_to_ply(output + ".ply");
+        if (has_format(options, "yaml"))
+            job.occupancy_grid->print_to_yaml(output);
+        if (has_format(options, "slices"))
+            job.occupancy_grid->print_to_folder(output + "_slices/");
+        if (has_format(options, "stats"))
+            statistics = job.occupancy_grid->get_statistics();
+    }
+    else if (job.color_grid) {
+        if (has_format(options, "ply"))
+            job.color_grid->write_mesh_to_ply(output + ".ply");
+        if (has_format(options, "yaml"))
+            job.color_grid->print_to_yaml(output + ".yaml");
+        if (has_format(options, "slices"))
+            job.color_grid->print_to_folder(output + "_slices/");
+        if (has_format(options, "stats"))
+            statistics = compute_statistics(BitGrid(job.color_grid->get_occupancy_grid()), job.color_grid->get_grid_size(),
+                                            job.color_grid->get_source(), job.color_grid->get_rotation());
+    }
+    else {
+        if (has_format(options, "png"))
+            render_SDF_to_png(*job.sdf, output + ".png");
+        if (has_format(options, "slices"))
+            job.sdf->print_to_folder(output + "_slices/");
+        if (has_format(options, "stats"))
+            statistics = job.sdf->get_statistics();
+    }
+
+    if (has_format(options, "stats")) {
+        std::lock_guard<std::mutex> lock(statistics_mutex);
+        std::cout << job.input << "\n";
+        print_statistics(statistics);
+    }
+
+    return true;
+};
+
+int main(int argc, char ** argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage();
+        return 1;
+    }
+
+#ifdef _OPENMP
+    if (options.threads > 0)
+        omp_set_num_threads(options.threads);
+#endif
+
+    // a folder goes through the batch pipeline, the outputs are named after the inputs
+    if (does_folder_exist(options.input)) {
+        std::vector< std::string > files = list_files(options.input, ".ply");
+        std::string input_folder = options.input;
+        while (input_folder.size() > 1 && input_folder[input_folder.size() - 1] == '/')
+            input_folder.erase(input_folder.size() - 1);
+
+        // the outputs keep the names of the inputs, so they go in a sibling folder by default
+        std::string output_folder = options.output_given ? options.output : input_folder + "_voxelized";
+        if (output_folder[output_folder.size() - 1] != '/')
+            output_folder += "/";
+        if (!does_folder_exist(output_folder))
+            create_folder(output_folder);
+        if (is_same_file(output_folder, input_folder)) {
+            std::cout << "Error: the output folder is the input folder, choose another one with --output\n";
+            return 1;
+        }
+
+        std::cout << "Progress: process " << files.size() << " files\n";
+        int written = run_batch_pipeline<Job>(files,
+            [&](const std::string & input, Job & job) {
+                std::string name = input.substr(input.find_last_of('/') + 1);
+                return load_job(input, output_folder + name.substr(0, name.find_last_of('.')), job);
+            },
+            [&](Job & job) {return compute_job(options, job);},
+            [&](Job & job) {return write_job(options, job);},
+            options.io_threads, options.io_threads, options.queue_size);
+        std::cout << "Progress: " << written << " of " << files.size() << " files written in " << output_folder << std::endl;
+        return written == int(files.size()) ? 0 : 1;
+    }
+
+    std::cout << "Progress: load data\n";
+    Job job;
+    if (!load_job(options.input, options.output, job) || !compute_job(options, job) || !write_job(options, job))
+        return 1;
+
+    return 0;
+}
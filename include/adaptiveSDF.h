@@ -0,0 +1,243 @@
+/*
+*   adaptively sampled distance field
+*   by R. Falque
+*   18/10/2026
+*/
+
+#ifndef ADAPTIVE_SDF_H
+#define ADAPTIVE_SDF_H
+
+#include <Eigen/Core>
+
+#include <vector>
+#include <iostream>
+#include <cmath>
+#include <memory>
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <stdint.h>
+
+#include "EigenTools/getMinMax.h"
+#include "EigenTools/nanoflannWrapper.h"
+
+// Octree over a cube holding the signed distance at the 8 corners of each
+// cell (same sign convention as the SDF class). A cell is split when the
+// trilinear interpolation of its corners is off by more than tolerance at
+// the 19 other points of its 3x3x3 lattice (face and edge midpoints and the
+// center), so the tree only refines where the field is not linear, i.e.
+// close to the surface and along the medial axis.
+//
+// The tree is built level by level. The lattice points of the cells of a
+// level are keyed by their integer coordinates on the finest lattice, so
+// the points shared by neighbouring cells (face and edge midpoints) are
+// evaluated once, in parallel; then the cells are tested in parallel, the
+// split ones get their 8 children appended contiguously, and the children
+// corners are taken from the lattice of their parent. Every distance is
+// thus evaluated once. Nodes are stored in a flat vector, a node only knows
+// the index of its first child, and the cell bounds are recomputed while
+// descending.
+class AdaptiveSDF
+{
+    private:
+        struct Node {
+            float values[8];                // corner c is at (c&1, (c>>1)&1, (c>>2)&1)
+            int first_child;                // -1 for leaves
+        };
+
+        Eigen::MatrixXd vertices_;
+        Eigen::MatrixXd normals_;
+        int max_depth_;                     // at most 19, so that the lattice coordinates (up to 2^20) fit the 21 bits of a key
+        double tolerance_;
+        double bounding_box_scale_;
+        std::vector< Node > nodes_;
+        Eigen::Vector3d source_;            // min corner of the root cell
+        double root_size_;
+        int depth_;
+        std::shared_ptr<nanoflann_wrapper> tree_;
+
+        // signed distance to the closest point
+        inline double distance(const Eigen::Vector3d & point) {
+            std::vector< int > closest_point = tree_->return_k_closest_points(point, 1);
+            Eigen::Vector3d delta = vertices_.col(closest_point[0]) - point;
+            double sign = delta.dot( normals_.col(closest_point[0]) );
+            sign /= std::abs(sign);
+            return delta.norm() * sign;
+        }
+
+        // key of a point of the finest lattice
+        static inline uint64_t lattice_key(const Eigen::Vector3i & point) {
+            return uint64_t(point(0)) | (uint64_t(point(1)) << 21) | (uint64_t(point(2)) << 42);
+        }
+
+        static inline double trilinear(const float * values, double x, double y, double z) {
+            double c00 = values[0] * (1 - x) + values[1] * x;
+            double c10 = values[2] * (1 - x) + values[3] * x;
+            double c01 = values[4] * (1 - x) + values[5] * x;
+            double c11 = values[6] * (1 - x) + values[7] * x;
+            return (c00 * (1 - y) + c10 * y) * (1 - z) + (c01 * (1 - y) + c11 * y) * z;
+        }
+
+    public:
+
+        AdaptiveSDF(Eigen::MatrixXd & vertices, Eigen::MatrixXd & normals, int max_depth, double tolerance, double bounding_box_scale)
+        {
+            vertices_ = vertices;
+            normals_ = normals;
+            max_depth_ = std::min(std::max(max_depth, 0), 19);
+            tolerance_ = tolerance;
+            bounding_box_scale_ = bounding_box_scale;
+
+            init();
+        }
+
+        // destructor
+        ~AdaptiveSDF()
+        {
+        }
+
+        //accessors
+        inline int get_number_of_nodes(){return nodes_.size();};
+        inline int get_depth(){return depth_;};
+        inline double get_root_size(){return root_size_;};
+        inline Eigen::Vector3d get_source(){return source_;};
+        inline size_t get_memory_usage(){return nodes_.size() * sizeof(Node);};
+
+        void init() {
+            Eigen::Vector3d min_point, max_point;
+            getMinMax(vertices_, min_point, max_point);
+
+            Eigen::Vector3d center = (min_point + max_point) / 2;
+            root_size_ = (max_point - min_point).maxCoeff() * bounding_box_scale_;
+            source_ = center - Eigen::Vector3d::Constant(root_size_ / 2);
+
+            tree_ = std::make_shared<nanoflann_wrapper>(vertices_);
+
+            nodes_.clear();
+            nodes_.resize(1);
+            nodes_[0].first_child = -1;
+            for (int c = 0; c < 8; ++c)
+                nodes_[0].values[c] = distance(source_ + root_size_ * Eigen::Vector3d(c & 1, (c >> 1) & 1, (c >> 2) & 1));
+
+            // cell origins in steps of the finest lattice, whose spacing is half the smallest cell
+            const double lattice_step = root_size_ / (1 << (max_depth_ + 1));
+            std::vector< int > frontier(1, 0);
+            std::vector< Eigen::Vector3i > frontier_origins(1, Eigen::Vector3i::Zero());
+            int half_cell = 1 << max_depth_;
+            depth_ = 0;
+
+            // the cells of the deepest level are leaves, their lattices are not needed
+            while (!frontier.empty() && depth_ < max_depth_) {
+                // distances at the lattice points of the level which are not cell corners, each evaluated once
+                std::vector< std::pair<uint64_t, float> > samples;
+                samples.reserve(19 * frontier.size());
+                for (int n = 0; n < frontier.size(); ++n)
+                    for (int k = 0; k < 3; ++k)
+                        for (int j = 0; j < 3; ++j)
+                            for (int i = 0; i < 3; ++i)
+                                if (i == 1 || j == 1 || k == 1)
+                                    samples.push_back(std::make_pair(lattice_key(frontier_origins[n] + half_cell * Eigen::Vector3i(i, j, k)), 0.0f));
+                std::sort(samples.begin(), samples.end());
+                samples.erase(std::unique(samples.begin(), samples.end()), samples.end());
+
+                #pragma omp parallel for schedule(dynamic, 64)
+                for (long int s = 0; s < samples.size(); ++s) {
+                    const uint64_t key = samples[s].first;
+                    const Eigen::Vector3d point(key & 0x1FFFFF, (key >> 21) & 0x1FFFFF, key >> 42);
+                    samples[s].second = distance(source_ + lattice_step * point);
+                }
+
+                // values on the 3x3x3 lattice of each cell, index i + 3j + 9k
+                std::vector< Eigen::Matrix<float, 27, 1> > lattices(frontier.size());
+                std::vector< char > split(frontier.size(), false);
+
+                #pragma omp parallel for schedule(dynamic, 16)
+                for (int n = 0; n < frontier.size(); ++n) {
+                    const Node & node = nodes_[frontier[n]];
+                    double max_error = 0;
+                    for (int k = 0; k < 3; ++k)
+                        for (int j = 0; j < 3; ++j)
+                            for (int i = 0; i < 3; ++i)
+                            {
+                                if (i != 1 && j != 1 && k != 1) {
+                                    lattices[n](i + 3*j + 9*k) = node.values[i/2 + 2*(j/2) + 4*(k/2)];
+                                    continue;
+                                }
+                                const uint64_t key = lattice_key(frontier_origins[n] + half_cell * Eigen::Vector3i(i, j, k));
+                                const float exact = std::lower_bound(samples.begin(), samples.end(), std::make_pair(key, -std::numeric_limits<float>::max()))->second;
+                                max_error = std::max(max_error, std::abs(exact - trilinear(node.values, 0.5*i, 0.5*j, 0.5*k)));
+                                lattices[n](i + 3*j + 9*k) = exact;
+                            }
+                    split[n] = max_error > tolerance_;
+                }
+
+                // append the children of the split cells contiguously
+                std::vector< int > first_child(frontier.size());
+                int number_of_nodes = nodes_.size();
+                for (int n = 0; n < frontier.size(); ++n) {
+                    first_child[n] = split[n] ? number_of_nodes : -1;
+                    if (split[n])
+                        number_of_nodes += 8;
+                }
+                nodes_.resize(number_of_nodes);
+
+                std::vector< int > next_frontier;
+                std::vector< Eigen::Vector3i > next_frontier_origins;
+                for (int n = 0; n < frontier.size(); ++n) {
+                    nodes_[frontier[n]].first_child = first_child[n];
+                    for (int child = 0; split[n] && child < 8; ++child) {
+                        Eigen::Vector3i offset(child & 1, (child >> 1) & 1, (child >> 2) & 1);
+                        next_frontier.push_back(first_child[n] + child);
+                        next_frontier_origins.push_back(frontier_origins[n] + half_cell * offset);
+                    }
+                }
+
+                #pragma omp parallel for
+                for (int n = 0; n < frontier.size(); ++n)
+                    for (int child = 0; split[n] && child < 8; ++child) {
+                        Node & node = nodes_[first_child[n] + child];
+                        node.first_child = -1;
+                        for (int c = 0; c < 8; ++c) {
+                            int i = (child & 1) + (c & 1);
+                            int j = ((child >> 1) & 1) + ((c >> 1) & 1);
+                            int k = ((child >> 2) & 1) + ((c >> 2) & 1);
+                            node.values[c] = lattices[n](i + 3*j + 9*k);
+                        }
+                    }
+
+                if (!next_frontier.empty())
+                    depth_++;
+                frontier.swap(next_frontier);
+                frontier_origins.swap(next_frontier_origins);
+                half_cell /= 2;
+            }
+
+            std::cout << "Progress: adaptive SDF with " << nodes_.size() << " nodes, depth " << depth_ << std::endl;
+        }
+
+        // trilinear interpolation in the leaf holding the point (clamped to the root cell)
+        inline double query(const Eigen::Vector3d & point) {
+            Eigen::Vector3d local = ((point - source_) / root_size_).cwiseMax(0).cwiseMin(1);
+            int index = 0;
+            while (nodes_[index].first_child >= 0) {
+                local *= 2;
+                int child = 0;
+                for (int i = 0; i < 3; ++i)
+                    if (local(i) >= 1) {
+                        child |= 1 << i;
+                        local(i) = std::min(local(i) - 1, 1.0);
+                    }
+                index = nodes_[index].first_child + child;
+            }
+            return trilinear(nodes_[index].values, local(0), local(1), local(2));
+        }
+
+        inline void query(const Eigen::MatrixXd & points, Eigen::VectorXd & distances) {
+            distances.resize(points.cols());
+            #pragma omp parallel for
+            for (long int i = 0; i < points.cols(); ++i)
+                distances(i) = query(points.col(i));
+        }
+};
+
+#endif
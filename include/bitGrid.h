@@ -0,0 +1,266 @@
+/*
+*   bit-packed occupancy grid and binary morphology
+*   by R. Falque
+*   18/10/2026
+*/
+
+#ifndef BIT_GRID_H
+#define BIT_GRID_H
+
+#include <Eigen/Core>
+#include <unsupported/Eigen/CXX11/Tensor>
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <stdint.h>
+
+// Occupancy packed along x: each (y, z) row is a run of 64 bits words,
+// voxel x is bit x%64 of word x/64, and the bits past the end of a row are
+// kept at zero so that rows can be counted and compared word by word.
+class BitGrid
+{
+    private:
+        int nx_, ny_, nz_;
+        int words_per_row_;
+        std::vector< uint64_t > words_;
+
+    public:
+
+        BitGrid() : nx_(0), ny_(0), nz_(0), words_per_row_(0) {}
+
+        BitGrid(int nx, int ny, int nz)
+        {
+            resize(nx, ny, nz);
+        }
+
+        BitGrid(const Eigen::Tensor<bool, 3> & grid)
+        {
+            resize(grid.dimension(0), grid.dimension(1), grid.dimension(2));
+
+            // the tensor is ColMajor, so each row is contiguous
+            const bool * data = grid.data();
+            #pragma omp parallel for
+            for (int z = 0; z < nz_; ++z)
+                for (int y = 0; y < ny_; ++y) {
+                    const bool * in = data + (long(z) * ny_ + y) * nx_;
+                    uint64_t * out = row(y, z);
+                    for (int x = 0; x < nx_; ++x)
+                        out[x >> 6] |= uint64_t(in[x]) << (x & 63);
+                }
+        }
+
+        inline void resize(int nx, int ny, int nz) {
+            nx_ = nx; ny_ = ny; nz_ = nz;
+            words_per_row_ = (nx + 63) / 64;
+            words_.assign(long(words_per_row_) * ny * nz, 0);
+        }
+
+        //accessors
+        inline int dimension(int i) const {return i == 0 ? nx_ : (i == 1 ? ny_ : nz_);};
+        inline int get_words_per_row() const {return words_per_row_;};
+        inline uint64_t * row(int y, int z) {return &words_[(long(z) * ny_ + y) * words_per_row_];};
+        inline const uint64_t * row(int y, int z) const {return &words_[(long(z) * ny_ + y) * words_per_row_];};
+        inline bool get(int x, int y, int z) const {return (row(y, z)[x >> 6] >> (x & 63)) & 1;};
+        inline void set(int x, int y, int z, bool value) {
+            uint64_t mask = uint64_t(1) << (x & 63);
+            if (value) row(y, z)[x >> 6] |= mask;
+            else row(y, z)[x >> 6] &= ~mask;
+        };
+
+        // mask of the valid bits of the last word of a row
+        inline uint64_t last_word_mask() const {
+            return (nx_ & 63) ? (uint64_t(1) << (nx_ & 63)) - 1 : ~uint64_t(0);
+        };
+
+        inline void to_tensor(Eigen::Tensor<bool, 3> & grid) const {
+            grid.resize(nx_, ny_, nz_);
+            bool * data = grid.data();
+            #pragma omp parallel for
+            for (int z = 0; z < nz_; ++z)
+                for (int y = 0; y < ny_; ++y) {
+                    const uint64_t * in = row(y, z);
+                    bool * out = data + (long(z) * ny_ + y) * nx_;
+                    for (int x = 0; x < nx_; ++x)
+                        out[x] = (in[x >> 6] >> (x & 63)) & 1;
+                }
+        };
+
+        // number of occupied voxels
+        inline long int count() const {
+            long int total = 0;
+            #pragma omp parallel for reduction(+:total)
+            for (long int i = 0; i < long(words_.size()); ++i)
+                total += __builtin_popcountll(words_[i]);
+            return total;
+        };
+};
+
+// structuring elements: the 6, 18 and 26 neighbourhoods applied radius
+// times (octahedron, rounded cube and cube), or the euclidean ball
+enum StructuringElement {CONNECTIVITY_6, CONNECTIVITY_18, CONNECTIVITY_26, SPHERICAL};
+
+// row offset (dy, dz) of a structuring element and its half extent along x
+struct RowRun
+{
+    int dy, dz, half_extent;
+};
+
+inline std::vector< RowRun > structuring_element_runs(StructuringElement element, int radius) {
+    std::vector< RowRun > runs;
+    for (int dz = -radius; dz <= radius; ++dz)
+        for (int dy = -radius; dy <= radius; ++dy) {
+            int half_extent = -1;
+            switch (element) {
+                case CONNECTIVITY_6:  half_extent = (std::abs(dy) + std::abs(dz) == 0) ? 1 : (std::abs(dy) + std::abs(dz) == 1 ? 0 : -1); break;
+                case CONNECTIVITY_18: half_extent = (std::abs(dy) + std::abs(dz) <= 1) ? 1 : 0; break;
+                case CONNECTIVITY_26: half_extent = 1; break;
+                case SPHERICAL:       half_extent = dy*dy + dz*dz <= radius*radius ? int(std::floor(std::sqrt(double(radius*radius - dy*dy - dz*dz)))) : -1; break;
+            }
+            if (half_extent >= 0)
+                runs.push_back(RowRun{dy, dz, half_extent});
+        }
+    return runs;
+};
+
+// out = in shifted by shift voxels along x (towards higher x if positive), zeros shifted in
+inline void shift_row(const uint64_t * in, uint64_t * out, int words, int shift) {
+    const int word_shift = std::abs(shift) >> 6, bit_shift = std::abs(shift) & 63;
+    for (int w = 0; w < words; ++w) {
+        const int source = shift >= 0 ? w - word_shift : w + word_shift;
+        uint64_t value = 0;
+        if (shift >= 0) {
+            if (source >= 0 && source < words)
+                value = in[source] << bit_shift;
+            if (bit_shift && source - 1 >= 0 && source - 1 < words)
+                value |= in[source - 1] >> (64 - bit_shift);
+        } else {
+            if (source >= 0 && source < words)
+                value = in[source] >> bit_shift;
+            if (bit_shift && source + 1 >= 0 && source + 1 < words)
+                value |= in[source + 1] << (64 - bit_shift);
+        }
+        out[w] = value;
+    }
+};
+
+// One pass of a dilation (OR) or an erosion (AND) by a structuring element
+// made of row runs. Each source row is first combined along x with its
+// neighbours within every half extent in use (shift and OR/AND on whole
+// words, doubling the covered extent at each step), then each output row
+// combines the rows of its runs word by word. Voxels outside the grid are
+// empty. Both steps are parallel over z slabs.
+inline void morphology_pass(const BitGrid & in, BitGrid & out, const std::vector< RowRun > & runs, bool dilation) {
+    const int nx = in.dimension(0), ny = in.dimension(1), nz = in.dimension(2);
+    const int words = in.get_words_per_row();
+    const uint64_t last_mask = in.last_word_mask();
+
+    int max_half_extent = 0;
+    for (int r = 0; r < runs.size(); ++r)
+        max_half_extent = std::max(max_half_extent, runs[r].half_extent);
+
+    // the source combined along x, for each half extent used
+    std::vector< bool > used(max_half_extent + 1, false);
+    for (int r = 0; r < runs.size(); ++r)
+        used[runs[r].half_extent] = true;
+    std::vector< BitGrid > along_x(max_half_extent + 1);
+    std::vector< const BitGrid * > sources(max_half_extent + 1, &in);
+    for (int e = 1; e <= max_half_extent; ++e) {
+        if (!used[e])
+            continue;
+        along_x[e].resize(nx, ny, nz);
+        sources[e] = &along_x[e];
+
+        #pragma omp parallel
+        {
+            std::vector< uint64_t > accumulator(words), source(words), shifted(words);
+            #pragma omp for
+            for (int z = 0; z < nz; ++z)
+                for (int y = 0; y < ny; ++y) {
+                    std::copy(in.row(y, z), in.row(y, z) + words, accumulator.begin());
+                    for (int covered = 0; covered < e; ) {
+                        const int step = std::min(covered + 1, e - covered);
+                        source = accumulator;
+                        for (int sign = -1; sign <= 1; sign += 2) {
+                            shift_row(&source[0], &shifted[0], words, sign * step);
+                            for (int w = 0; w < words; ++w)
+                                accumulator[w] = dilation ? accumulator[w] | shifted[w] : accumulator[w] & shifted[w];
+                        }
+                        covered += step;
+                    }
+                    std::copy(accumulator.begin(), accumulator.end(), along_x[e].row(y, z));
+                }
+        }
+    }
+
+    out.resize(nx, ny, nz);
+    #pragma omp parallel for
+    for (int z = 0; z < nz; ++z)
+        for (int y = 0; y < ny; ++y) {
+            uint64_t * target = out.row(y, z);
+            std::fill(target, target + words, dilation ? uint64_t(0) : ~uint64_t(0));
+            for (int r = 0; r < runs.size(); ++r) {
+                const int source_y = y + runs[r].dy, source_z = z + runs[r].dz;
+                const bool inside = source_y >= 0 && source_y < ny && source_z >= 0 && source_z < nz;
+                if (!inside) {
+                    if (!dilation)
+                        std::fill(target, target + words, uint64_t(0));
+                    continue;
+                }
+                const uint64_t * source = sources[runs[r].half_extent]->row(source_y, source_z);
+                for (int w = 0; w < words; ++w)
+                    target[w] = dilation ? target[w] | source[w] : target[w] & source[w];
+            }
+            target[words - 1] &= last_mask;
+        }
+};
+
+inline void morphology(const BitGrid & in, BitGrid & out, StructuringElement element, int radius, bool dilation) {
+    if (radius <= 0) {
+        out = in;
+        return;
+    }
+    if (&in == &out) {
+        BitGrid copy(in);
+        morphology(copy, out, element, radius, dilation);
+        return;
+    }
+
+    // the euclidean ball is done in one pass
+    if (element == SPHERICAL) {
+        morphology_pass(in, out, structuring_element_runs(element, radius), dilation);
+        return;
+    }
+
+    // the cube is separable: one pass along each axis
+    BitGrid temporary;
+    if (element == CONNECTIVITY_26) {
+        std::vector< RowRun > along_x(1, RowRun{0, 0, radius}), along_y, along_z;
+        for (int d = -radius; d <= radius; ++d) {
+            along_y.push_back(RowRun{d, 0, 0});
+            along_z.push_back(RowRun{0, d, 0});
+        }
+        morphology_pass(in, out, along_x, dilation);
+        morphology_pass(out, temporary, along_y, dilation);
+        morphology_pass(temporary, out, along_z, dilation);
+        return;
+    }
+
+    // the other neighbourhoods are repeated
+    std::vector< RowRun > runs = structuring_element_runs(element, 1);
+    morphology_pass(in, out, runs, dilation);
+    for (int i = 1; i < radius; ++i) {
+        morphology_pass(out, temporary, runs, dilation);
+        std::swap(out, temporary);
+    }
+};
+
+inline void dilate(const BitGrid & in, BitGrid & out, StructuringElement element, int radius) {
+    morphology(in, out, element, radius, true);
+};
+
+inline void erode(const BitGrid & in, BitGrid & out, StructuringElement element, int radius) {
+    morphology(in, out, element, radius, false);
+};
+
+#endif
@@ -0,0 +1,206 @@
+/*
+*   batched collision queries of primitives against a SDF
+*   by R. Falque
+*   18/10/2026
+*/
+
+#ifndef COLLISION_SDF_H
+#define COLLISION_SDF_H
+
+#include <Eigen/Core>
+
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "sdf.h"
+
+// The penetration of a primitive is the largest SDF value over its volume
+// (the SDF is positive inside), i.e. how deep it reaches into the object,
+// and the contact normal is -grad at the deepest point, the direction in
+// which to move the primitive out. Primitives not in contact get a
+// penetration <= 0 whose opposite is a lower bound of their clearance, and
+// a zero normal.
+//
+// All the queries rely on the SDF being 1-Lipschitz: the SDF over a cell of
+// half diagonal r around c is at most sdf(c) + r. A primitive whose bound
+// is negative is dropped after a single lookup at its center, and the
+// others are explored by branch and bound, where the cells that cannot beat
+// the deepest point found so far are pruned. Queries go by blocks of 8
+// through SDF::sample_block_outside and the blocks are spread over the
+// threads: outside the grid the SDF is lowered by the distance to the grid
+// box, so that a primitive away from the grid is not in contact with the
+// clamped values of its border.
+
+// part of a primitive: center and half axes (columns, zero for the unused ones)
+struct CollisionCell
+{
+    Eigen::Vector3d center;
+    Eigen::Matrix3d half_axes;
+    double value;                       // sdf at the center, plus the radius of the primitive
+};
+
+// deepest point of a primitive whose root cell has already been evaluated,
+// cells are refined until their half diagonal is below resolution
+inline double find_deepest_point(SDF & sdf, const CollisionCell & root, double offset, double resolution, Eigen::Vector3d & deepest)
+{
+    // a segment is cut in 8 pieces, a box in 8 octants (4 quadrants if flat)
+    int axes[3], number_of_axes = 0;
+    for (int i = 0; i < 3; ++i)
+        if (root.half_axes.col(i).squaredNorm() > 0)
+            axes[number_of_axes++] = i;
+    const int pieces = number_of_axes == 1 ? 8 : 2;
+    const int number_of_children = number_of_axes == 0 ? 1 : (number_of_axes == 1 ? 8 : 1 << number_of_axes);
+
+    double best = -std::numeric_limits<double>::max();
+    double best_bound = -std::numeric_limits<double>::max();
+    std::vector< CollisionCell > stack(1, root);
+
+    while (!stack.empty()) {
+        CollisionCell cell = stack.back();
+        stack.pop_back();
+
+        if (cell.value > best) {
+            best = cell.value;
+            deepest = cell.center;
+        }
+
+        const double radius = cell.half_axes.colwise().norm().norm();
+        const double bound = cell.value + radius;
+        if (bound <= std::max(best, 0.0) || radius <= resolution) {
+            best_bound = std::max(best_bound, std::min(bound, 0.0));
+            continue;
+        }
+
+        // children, evaluated with one packed lookup
+        CollisionCell children[8];
+        double points[24], distances[8];
+        for (int c = 0; c < number_of_children; ++c) {
+            children[c].center = cell.center;
+            children[c].half_axes = cell.half_axes;
+            int index = c;
+            for (int a = 0; a < number_of_axes; ++a) {
+                const int piece = index % pieces;
+                index /= pieces;
+                children[c].half_axes.col(axes[a]) /= pieces;
+                children[c].center += (2.0 * piece + 1 - pieces) * children[c].half_axes.col(axes[a]);
+            }
+            Eigen::Map<Eigen::Vector3d>(points + 3*c) = children[c].center;
+        }
+        sdf.sample_block_outside(points, number_of_children, distances);
+        for (int c = 0; c < number_of_children; ++c)
+            children[c].value = distances[c] + offset;
+
+        // deepest child last, so that it is explored first
+        std::sort(children, children + number_of_children,
+                  [](const CollisionCell & a, const CollisionCell & b) {return a.value < b.value;});
+        stack.insert(stack.end(), children, children + number_of_children);
+    }
+
+    return best > 0 ? best : best_bound;
+};
+
+// shared driver: root cells of 8 primitives are evaluated with one lookup
+template <typename MakeRoot>
+inline void collide_primitives(SDF & sdf, long int number_of_primitives, const Eigen::VectorXd & offsets, MakeRoot make_root,
+                               Eigen::VectorXd & penetrations, Eigen::MatrixXd & normals)
+{
+    const double resolution = sdf.get_grid_size();
+    const long int number_of_blocks = (number_of_primitives + 7) / 8;
+    penetrations.resize(number_of_primitives);
+    normals.setZero(3, number_of_primitives);
+
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (long int b = 0; b < number_of_blocks; ++b) {
+        const int count = std::min(8L, number_of_primitives - 8*b);
+        CollisionCell roots[8];
+        double points[24], distances[8], gradients[24];
+        for (int l = 0; l < count; ++l) {
+            roots[l] = make_root(8*b + l);
+            Eigen::Map<Eigen::Vector3d>(points + 3*l) = roots[l].center;
+        }
+        sdf.sample_block_outside(points, count, distances);
+
+        for (int l = 0; l < count; ++l) {
+            const long int i = 8*b + l;
+            roots[l].value = distances[l] + offsets(i);
+
+            // early out with the Lipschitz bound of the whole primitive
+            const double bound = roots[l].value + roots[l].half_axes.colwise().norm().norm();
+            if (bound <= 0) {
+                penetrations(i) = bound;
+                continue;
+            }
+
+            Eigen::Vector3d deepest = roots[l].center;
+            penetrations(i) = find_deepest_point(sdf, roots[l], offsets(i), resolution, deepest);
+            Eigen::Map<Eigen::Vector3d>(points + 3*l) = deepest;
+        }
+
+        sdf.sample_block(points, count, distances, gradients);
+        for (int l = 0; l < count; ++l) {
+            Eigen::Vector3d normal = -Eigen::Map<Eigen::Vector3d>(gradients + 3*l);
+            if (penetrations(8*b + l) > 0 && normal.norm() > 0)
+                normals.col(8*b + l) = normal.normalized();
+        }
+    }
+};
+
+// spheres: penetration = radius + sdf(center)
+inline void collide_spheres(SDF & sdf, const Eigen::MatrixXd & centers, const Eigen::VectorXd & radii,
+                            Eigen::VectorXd & penetrations, Eigen::MatrixXd & normals)
+{
+    const long int number_of_spheres = centers.cols();
+    const long int number_of_blocks = (number_of_spheres + 7) / 8;
+    penetrations.resize(number_of_spheres);
+    normals.setZero(3, number_of_spheres);
+
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (long int b = 0; b < number_of_blocks; ++b) {
+        const int count = std::min(8L, number_of_spheres - 8*b);
+        double points[24], distances[8], gradients[24];
+        for (int l = 0; l < count; ++l)
+            Eigen::Map<Eigen::Vector3d>(points + 3*l) = centers.col(8*b + l);
+        sdf.sample_block_outside(points, count, distances, gradients);
+
+        for (int l = 0; l < count; ++l) {
+            const long int i = 8*b + l;
+            penetrations(i) = distances[l] + radii(i);
+            Eigen::Vector3d normal = -Eigen::Map<Eigen::Vector3d>(gradients + 3*l);
+            if (penetrations(i) > 0 && normal.norm() > 0)
+                normals.col(i) = normal.normalized();
+        }
+    }
+};
+
+// capsules: segments [first_points, second_points] inflated by radii
+inline void collide_capsules(SDF & sdf, const Eigen::MatrixXd & first_points, const Eigen::MatrixXd & second_points, const Eigen::VectorXd & radii,
+                             Eigen::VectorXd & penetrations, Eigen::MatrixXd & normals)
+{
+    collide_primitives(sdf, first_points.cols(), radii,
+        [&](long int i) {
+            CollisionCell root;
+            root.center = (first_points.col(i) + second_points.col(i)) / 2;
+            root.half_axes.setZero();
+            root.half_axes.col(0) = (second_points.col(i) - first_points.col(i)) / 2;
+            return root;
+        },
+        penetrations, normals);
+};
+
+// oriented boxes: center, rotation (box frame to world frame) and half extents along the box axes
+inline void collide_boxes(SDF & sdf, const Eigen::MatrixXd & centers, const std::vector< Eigen::Matrix3d > & rotations, const Eigen::MatrixXd & half_extents,
+                          Eigen::VectorXd & penetrations, Eigen::MatrixXd & normals)
+{
+    collide_primitives(sdf, centers.cols(), Eigen::VectorXd::Zero(centers.cols()),
+        [&](long int i) {
+            CollisionCell root;
+            root.center = centers.col(i);
+            root.half_axes = rotations[i] * half_extents.col(i).asDiagonal();
+            return root;
+        },
+        penetrations, normals);
+};
+
+#endif
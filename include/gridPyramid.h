@@ -0,0 +1,226 @@
+/*
+*   multi-resolution pyramids over occupancy and SDF grids
+*   by R. Falque
+*   18/10/2026
+*/
+
+#ifndef GRID_PYRAMID_H
+#define GRID_PYRAMID_H
+
+#include <Eigen/Core>
+#include <unsupported/Eigen/CXX11/Tensor>
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+#include "occupancyGrid.h"
+#include "sdf.h"
+
+// Build the coarser levels of a pyramid. Each level is reduced from the
+// previous one over 2x2x2 blocks (the last block of an odd dimension is
+// partial), in parallel over slices. Reading each level once from the one
+// below is a single streaming pass over 8/7 of the finest grid.
+template <typename T, typename Reduction>
+inline void build_pyramid(std::vector< Eigen::Tensor<T, 3> > & levels, Reduction reduce) {
+    while (levels.back().dimension(0) > 1 || levels.back().dimension(1) > 1 || levels.back().dimension(2) > 1) {
+        const Eigen::Tensor<T, 3> & fine = levels.back();
+        Eigen::Tensor<T, 3> coarse((fine.dimension(0) + 1) / 2, (fine.dimension(1) + 1) / 2, (fine.dimension(2) + 1) / 2);
+
+        #pragma omp parallel for
+        for (int z = 0; z < coarse.dimension(2); ++z)
+            for (int y = 0; y < coarse.dimension(1); ++y)
+                for (int x = 0; x < coarse.dimension(0); ++x)
+                {
+                    T value = fine(2*x, 2*y, 2*z);
+                    for (int dz = 0; dz < 2 && 2*z+dz < fine.dimension(2); ++dz)
+                        for (int dy = 0; dy < 2 && 2*y+dy < fine.dimension(1); ++dy)
+                            for (int dx = 0; dx < 2 && 2*x+dx < fine.dimension(0); ++dx)
+                                value = reduce(value, fine(2*x+dx, 2*y+dy, 2*z+dz));
+                    coarse(x, y, z) = value;
+                }
+
+        levels.push_back(coarse);
+    }
+};
+
+// Range of finest voxels [first, last] overlapped by a world-space box
+// (conservative for rotated grids). Voxel i is the cube of side grid_size
+// centered on its sample, [i - 0.5, i + 0.5] in grid coordinates, so a box
+// smaller than a voxel still overlaps the one (or ones) it lies in.
+inline bool box_to_voxel_range(const Eigen::Vector3d & box_min, const Eigen::Vector3d & box_max,
+                               const Eigen::Vector3d & source, const Eigen::Matrix3d & rotation, double grid_size,
+                               const Eigen::Vector3i & number_of_bins, Eigen::Vector3i & first, Eigen::Vector3i & last) {
+    Eigen::Vector3d local_min = Eigen::Vector3d::Constant(std::numeric_limits<double>::max());
+    Eigen::Vector3d local_max = -local_min;
+    for (int corner = 0; corner < 8; ++corner) {
+        Eigen::Vector3d point((corner & 1) ? box_max(0) : box_min(0),
+                              (corner & 2) ? box_max(1) : box_min(1),
+                              (corner & 4) ? box_max(2) : box_min(2));
+        point = (rotation.transpose() * point - source) / grid_size;
+        local_min = local_min.cwiseMin(point);
+        local_max = local_max.cwiseMax(point);
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        first(i) = int(std::min(double(number_of_bins(i)), std::max(0.0, std::floor(local_min(i) + 0.5))));
+        last(i) = int(std::max(-1.0, std::min(double(number_of_bins(i) - 1), std::ceil(local_max(i) - 0.5))));
+        if (first(i) > last(i))
+            return false;
+    }
+    return true;
+};
+
+// OR pyramid of an occupancy grid: a coarse cell is occupied if any voxel below it is
+class OccupancyPyramid
+{
+    private:
+        std::vector< Eigen::Tensor<bool, 3> > levels_;      // levels_[0] is the occupancy grid itself
+        double grid_size_;
+        Eigen::Vector3d source_;
+        Eigen::Matrix3d rotation_;
+
+        struct Or {
+            bool operator()(bool a, bool b) const {return a || b;}
+        };
+
+        // is any voxel of [first, last] occupied below the cell (x, y, z) of level
+        bool any_occupied(int level, int x, int y, int z, const Eigen::Vector3i & first, const Eigen::Vector3i & last) const {
+            if (!levels_[level](x, y, z))
+                return false;
+
+            Eigen::Vector3i cell_first = Eigen::Vector3i(x, y, z) * (1 << level);
+            Eigen::Vector3i cell_last = cell_first.array() + (1 << level) - 1;
+            if ((cell_first.array() >= first.array()).all() && (cell_last.array() <= last.array()).all())
+                return true;
+
+            for (int dz = 0; dz < 2; ++dz)
+                for (int dy = 0; dy < 2; ++dy)
+                    for (int dx = 0; dx < 2; ++dx)
+                    {
+                        Eigen::Vector3i child(2*x+dx, 2*y+dy, 2*z+dz);
+                        const Eigen::Tensor<bool, 3> & below = levels_[level-1];
+                        if (child(0) >= below.dimension(0) || child(1) >= below.dimension(1) || child(2) >= below.dimension(2))
+                            continue;
+
+                        Eigen::Vector3i child_first = child * (1 << (level-1));
+                        Eigen::Vector3i child_last = child_first.array() + (1 << (level-1)) - 1;
+                        if ((child_last.array() < first.array()).any() || (child_first.array() > last.array()).any())
+                            continue;
+
+                        if (any_occupied(level-1, child(0), child(1), child(2), first, last))
+                            return true;
+                    }
+            return false;
+        };
+
+    public:
+
+        OccupancyPyramid(OccupancyGrid & occupancy_grid)
+        {
+            grid_size_ = occupancy_grid.get_grid_size();
+            source_ = occupancy_grid.get_source();
+            rotation_ = occupancy_grid.get_rotation();
+
+            levels_.push_back(occupancy_grid.get_occupancy_grid());
+            build_pyramid(levels_, Or());
+        }
+
+        // destructor
+        ~OccupancyPyramid()
+        {
+        }
+
+        //accessors
+        inline int get_number_of_levels(){return levels_.size();};
+        inline const Eigen::Tensor<bool, 3> & get_level(int level){return levels_[level];};
+
+        // true if any voxel of the world-space box is occupied, only descending into occupied coarse cells
+        inline bool is_occupied(const Eigen::Vector3d & box_min, const Eigen::Vector3d & box_max) {
+            Eigen::Vector3i number_of_bins(levels_[0].dimension(0), levels_[0].dimension(1), levels_[0].dimension(2));
+            Eigen::Vector3i first, last;
+            if (!box_to_voxel_range(box_min, box_max, source_, rotation_, grid_size_, number_of_bins, first, last))
+                return false;
+
+            return any_occupied(levels_.size()-1, 0, 0, 0, first, last);
+        };
+};
+
+// max pyramid of a SDF (positive inside): a coarse cell stores the largest
+// signed distance below it, so a cell below -clearance is outside the solid
+// and further than clearance from its surface everywhere
+class SDFPyramid
+{
+    private:
+        std::vector< Eigen::Tensor<double, 3> > levels_;    // levels_[0] is the SDF itself
+        double grid_size_;
+        Eigen::Vector3d source_;
+        Eigen::Matrix3d rotation_;
+
+        struct Max {
+            double operator()(double a, double b) const {return std::max(a, b);}
+        };
+
+        // is every voxel of [first, last] below the cell (x, y, z) of level outside and further than clearance from the surface
+        bool all_free(int level, int x, int y, int z, const Eigen::Vector3i & first, const Eigen::Vector3i & last, double clearance) const {
+            if (levels_[level](x, y, z) < -clearance)
+                return true;
+            if (level == 0)
+                return false;
+
+            for (int dz = 0; dz < 2; ++dz)
+                for (int dy = 0; dy < 2; ++dy)
+                    for (int dx = 0; dx < 2; ++dx)
+                    {
+                        Eigen::Vector3i child(2*x+dx, 2*y+dy, 2*z+dz);
+                        const Eigen::Tensor<double, 3> & below = levels_[level-1];
+                        if (child(0) >= below.dimension(0) || child(1) >= below.dimension(1) || child(2) >= below.dimension(2))
+                            continue;
+
+                        Eigen::Vector3i child_first = child * (1 << (level-1));
+                        Eigen::Vector3i child_last = child_first.array() + (1 << (level-1)) - 1;
+                        if ((child_last.array() < first.array()).any() || (child_first.array() > last.array()).any())
+                            continue;
+
+                        if (!all_free(level-1, child(0), child(1), child(2), first, last, clearance))
+                            return false;
+                    }
+            return true;
+        };
+
+    public:
+
+        SDFPyramid(SDF & sdf)
+        {
+            grid_size_ = sdf.get_grid_size();
+            source_ = sdf.get_source();
+            rotation_ = sdf.get_rotation();
+
+            levels_.push_back(sdf.get_SDF());
+            build_pyramid(levels_, Max());
+        }
+
+        // destructor
+        ~SDFPyramid()
+        {
+        }
+
+        //accessors
+        inline int get_number_of_levels(){return levels_.size();};
+        inline const Eigen::Tensor<double, 3> & get_level(int level){return levels_[level];};
+
+        // true if every voxel of the world-space box is outside the solid and
+        // further than clearance from its surface; a box outside the grid is
+        // unknown space and is not free
+        inline bool is_free(const Eigen::Vector3d & box_min, const Eigen::Vector3d & box_max, double clearance) {
+            Eigen::Vector3i number_of_bins(levels_[0].dimension(0), levels_[0].dimension(1), levels_[0].dimension(2));
+            Eigen::Vector3i first, last;
+            if (!box_to_voxel_range(box_min, box_max, source_, rotation_, grid_size_, number_of_bins, first, last))
+                return false;
+
+            return all_free(levels_.size()-1, 0, 0, 0, first, last, clearance);
+        };
+};
+
+#endif
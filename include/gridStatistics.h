@@ -0,0 +1,191 @@
+/*
+*   mass properties of a voxelized solid
+*   by R. Falque
+*   18/10/2026
+*/
+
+#ifndef GRID_STATISTICS_H
+#define GRID_STATISTICS_H
+
+#include <Eigen/Core>
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+
+#include "bitGrid.h"
+
+// Mass properties of the occupied voxels, each voxel being a cube of side
+// grid_size centered on its grid point, with a unit density. The centroid
+// and the inertia tensor (about the centroid) are in the world frame, the
+// extents are the box of the occupied cubes in the grid frame, which is
+// the oriented bounding box when the grid is oriented.
+struct GridStatistics
+{
+    long int number_of_voxels;
+    long int number_of_boundary_faces;  // faces between an occupied and an empty voxel
+    double volume;
+    double surface_area;                // boundary faces corrected for the staircase, see below
+    Eigen::Vector3d centroid;
+    Eigen::Matrix3d inertia;
+    Eigen::Vector3d box_min, box_max;   // grid frame
+    Eigen::Matrix3d rotation;           // grid frame to world frame
+};
+
+// sums over the occupied voxels of a row, in grid indices
+struct RowMoments
+{
+    int64_t count, sum_x, sum_xx;
+    int min_x, max_x;
+};
+
+// Moments of the set bits of a row: the index of bit b of word w is 64w + b,
+// and the bits of b are summed one bit plane at a time with popcount, so
+// sum b = sum_k 2^k |word & plane_k| and sum b^2 = sum_jk 2^(j+k) |word & plane_j & plane_k|.
+inline RowMoments row_moments(const uint64_t * row, int words) {
+    static const uint64_t planes[6] = {0xAAAAAAAAAAAAAAAAull, 0xCCCCCCCCCCCCCCCCull, 0xF0F0F0F0F0F0F0F0ull,
+                                       0xFF00FF00FF00FF00ull, 0xFFFF0000FFFF0000ull, 0xFFFFFFFF00000000ull};
+    RowMoments moments = {0, 0, 0, -1, -1};
+    for (int w = 0; w < words; ++w) {
+        const uint64_t word = row[w];
+        if (!word)
+            continue;
+        const int64_t count = __builtin_popcountll(word);
+        int64_t sum_b = 0, sum_bb = 0;
+        for (int j = 0; j < 6; ++j) {
+            const uint64_t in_plane = word & planes[j];
+            sum_b += int64_t(__builtin_popcountll(in_plane)) << j;
+            sum_bb += int64_t(__builtin_popcountll(in_plane)) << (2*j);
+            for (int k = j + 1; k < 6; ++k)
+                sum_bb += int64_t(__builtin_popcountll(in_plane & planes[k])) << (j + k + 1);
+        }
+        const int64_t offset = 64 * int64_t(w);
+        moments.count += count;
+        moments.sum_x += offset * count + sum_b;
+        moments.sum_xx += offset * offset * count + 2 * offset * sum_b + sum_bb;
+        if (moments.min_x < 0)
+            moments.min_x = int(offset) + __builtin_ctzll(word);
+        moments.max_x = int(offset) + 63 - __builtin_clzll(word);
+    }
+    return moments;
+};
+
+// One parallel pass over the rows of the grid: each row adds its moments,
+// its faces along x (bits whose neighbour along x is empty) and its faces
+// with the next rows along y and z (xor of the rows), all on whole words.
+//
+// Counting the faces overestimates the area of a smooth surface by the
+// factor |nx| + |ny| + |nz|, whose average over all the orientations is
+// 3/2, so the surface area is the face area divided by 3/2.
+inline GridStatistics compute_statistics(const BitGrid & grid, double grid_size, const Eigen::Vector3d & source, const Eigen::Matrix3d & rotation)
+{
+    const int nx = grid.dimension(0), ny = grid.dimension(1), nz = grid.dimension(2);
+    const int words = grid.get_words_per_row();
+
+    // sums over the voxels: count, x, y, z, xx, yy, zz, xy, xz, yz, then the faces
+    const int number_of_sums = 11;
+    int64_t sums[number_of_sums] = {0};
+    int min_index[3] = {nx, ny, nz}, max_index[3] = {-1, -1, -1};
+
+    #pragma omp parallel
+    {
+        int64_t local[number_of_sums] = {0};
+        int local_min[3] = {nx, ny, nz}, local_max[3] = {-1, -1, -1};
+        std::vector< uint64_t > shifted(words);
+
+        #pragma omp for nowait
+        for (int z = 0; z < nz; ++z)
+            for (int y = 0; y < ny; ++y) {
+                const uint64_t * row = grid.row(y, z);
+
+                // faces with the next row along y and z, or with the outside
+                const uint64_t * next_y = y + 1 < ny ? grid.row(y + 1, z) : NULL;
+                const uint64_t * next_z = z + 1 < nz ? grid.row(y, z + 1) : NULL;
+                for (int w = 0; w < words; ++w) {
+                    local[10] += __builtin_popcountll(next_y ? row[w] ^ next_y[w] : row[w]);
+                    local[10] += __builtin_popcountll(next_z ? row[w] ^ next_z[w] : row[w]);
+                }
+                if (y == 0 || z == 0)
+                    for (int w = 0; w < words; ++w)
+                        local[10] += __builtin_popcountll(row[w]) * ((y == 0) + (z == 0));
+
+                RowMoments moments = row_moments(row, words);
+                if (!moments.count)
+                    continue;
+
+                // faces along x: occupied voxels whose neighbour on either side is empty
+                for (int sign = -1; sign <= 1; sign += 2) {
+                    shift_row(row, &shifted[0], words, sign);
+                    for (int w = 0; w < words; ++w)
+                        local[10] += __builtin_popcountll(row[w] & ~shifted[w]);
+                }
+
+                local[0] += moments.count;
+                local[1] += moments.sum_x;
+                local[2] += moments.count * y;
+                local[3] += moments.count * z;
+                local[4] += moments.sum_xx;
+                local[5] += moments.count * y * y;
+                local[6] += moments.count * z * z;
+                local[7] += moments.sum_x * y;
+                local[8] += moments.sum_x * z;
+                local[9] += moments.count * y * z;
+
+                local_min[0] = std::min(local_min[0], moments.min_x);
+                local_max[0] = std::max(local_max[0], moments.max_x);
+                local_min[1] = std::min(local_min[1], y);
+                local_max[1] = std::max(local_max[1], y);
+                local_min[2] = std::min(local_min[2], z);
+                local_max[2] = std::max(local_max[2], z);
+            }
+
+        #pragma omp critical
+        {
+            for (int i = 0; i < number_of_sums; ++i)
+                sums[i] += local[i];
+            for (int i = 0; i < 3; ++i) {
+                min_index[i] = std::min(min_index[i], local_min[i]);
+                max_index[i] = std::max(max_index[i], local_max[i]);
+            }
+        }
+    }
+
+    GridStatistics statistics;
+    const double voxel_volume = grid_size * grid_size * grid_size;
+    statistics.number_of_voxels = sums[0];
+    statistics.number_of_boundary_faces = sums[10];
+    statistics.volume = sums[0] * voxel_volume;
+    statistics.surface_area = sums[10] * grid_size * grid_size / 1.5;
+    statistics.rotation = rotation;
+
+    if (!sums[0]) {
+        statistics.centroid = rotation * source;
+        statistics.inertia.setZero();
+        statistics.box_min = statistics.box_max = source;
+        return statistics;
+    }
+
+    // centroid and covariance of the voxel centers, in grid indices
+    const double n = double(sums[0]);
+    const Eigen::Vector3d mean(sums[1] / n, sums[2] / n, sums[3] / n);
+    Eigen::Matrix3d second_moments;
+    second_moments << sums[4], sums[7], sums[8],
+                      sums[7], sums[5], sums[9],
+                      sums[8], sums[9], sums[6];
+    const Eigen::Matrix3d covariance = grid_size * grid_size * (second_moments - n * mean * mean.transpose());
+
+    // inertia of point masses at the voxel centers, plus the inertia of each cube about its center
+    const Eigen::Matrix3d world_covariance = rotation * covariance * rotation.transpose();
+    statistics.centroid = rotation * (source + grid_size * mean);
+    statistics.inertia = voxel_volume * (world_covariance.trace() * Eigen::Matrix3d::Identity() - world_covariance)
+                       + n * voxel_volume * grid_size * grid_size / 6 * Eigen::Matrix3d::Identity();
+
+    for (int i = 0; i < 3; ++i) {
+        statistics.box_min(i) = source(i) + grid_size * (min_index[i] - 0.5);
+        statistics.box_max(i) = source(i) + grid_size * (max_index[i] + 0.5);
+    }
+
+    return statistics;
+};
+
+#endif
@@ -0,0 +1,252 @@
+/*
+*   curve skeleton of the inside of a SDF
+*   by R. Falque
+*   18/10/2026
+*/
+
+#ifndef MEDIAL_AXIS_H
+#define MEDIAL_AXIS_H
+
+#include <Eigen/Core>
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+#include <stdint.h>
+
+#include "sdf.h"
+
+// offsets of the 27 voxels of a 3x3x3 neighbourhood, the center is 13
+inline int neighbourhood_index(int dx, int dy, int dz) {return (dx + 1) + 3 * (dy + 1) + 9 * (dz + 1);};
+
+// adjacency of the voxels of a 3x3x3 neighbourhood, center excluded
+struct NeighbourhoodTables
+{
+    std::vector< std::vector<int> > adjacent_26, adjacent_6;
+    bool in_18[27];
+
+    NeighbourhoodTables() : adjacent_26(27), adjacent_6(27) {
+        for (int a = 0; a < 27; ++a) {
+            const int ax = a % 3, ay = (a / 3) % 3, az = a / 9;
+            in_18[a] = std::abs(ax - 1) + std::abs(ay - 1) + std::abs(az - 1) <= 2;
+            for (int b = 0; b < 27; ++b) {
+                const int bx = b % 3, by = (b / 3) % 3, bz = b / 9;
+                const int manhattan = std::abs(ax - bx) + std::abs(ay - by) + std::abs(az - bz);
+                const int chebyshev = std::max(std::abs(ax - bx), std::max(std::abs(ay - by), std::abs(az - bz)));
+                if (a == 13 || b == 13)
+                    continue;
+                if (a != b && chebyshev == 1)
+                    adjacent_26[a].push_back(b);
+                if (manhattan == 1)
+                    adjacent_6[a].push_back(b);
+            }
+        }
+    }
+};
+
+// A voxel is simple when removing it does not change the topology: its
+// object neighbours (26-connectivity, center excluded) form one component,
+// and its background neighbours within the 18 neighbourhood (6-connectivity)
+// form one component touching the center by a face.
+inline bool is_simple(const bool neighbourhood[27]) {
+    static const NeighbourhoodTables tables;
+    const std::vector< std::vector<int> > & adjacent_26 = tables.adjacent_26;
+    const std::vector< std::vector<int> > & adjacent_6 = tables.adjacent_6;
+    const bool * in_18 = tables.in_18;
+
+    int stack[27];
+    bool visited[27];
+
+    // object components
+    int components = 0;
+    std::fill(visited, visited + 27, false);
+    for (int seed = 0; seed < 27; ++seed) {
+        if (seed == 13 || !neighbourhood[seed] || visited[seed])
+            continue;
+        if (++components > 1)
+            return false;
+        int top = 0;
+        stack[top++] = seed;
+        visited[seed] = true;
+        while (top) {
+            const int a = stack[--top];
+            for (int i = 0; i < adjacent_26[a].size(); ++i) {
+                const int b = adjacent_26[a][i];
+                if (neighbourhood[b] && !visited[b]) {
+                    visited[b] = true;
+                    stack[top++] = b;
+                }
+            }
+        }
+    }
+    if (components != 1)
+        return false;
+
+    // background components 6-adjacent to the center
+    const int faces[6] = {4, 10, 12, 14, 16, 22};
+    components = 0;
+    std::fill(visited, visited + 27, false);
+    for (int f = 0; f < 6; ++f) {
+        const int seed = faces[f];
+        if (neighbourhood[seed] || visited[seed])
+            continue;
+        if (++components > 1)
+            return false;
+        int top = 0;
+        stack[top++] = seed;
+        visited[seed] = true;
+        while (top) {
+            const int a = stack[--top];
+            for (int i = 0; i < adjacent_6[a].size(); ++i) {
+                const int b = adjacent_6[a][i];
+                if (in_18[b] && !neighbourhood[b] && !visited[b]) {
+                    visited[b] = true;
+                    stack[top++] = b;
+                }
+            }
+        }
+    }
+    return components == 1;
+};
+
+// Curve skeleton of the inside (positive side) of a SDF, as a graph whose
+// nodes are voxels in the world frame, with the distance to the surface of
+// each node as its radius.
+//
+// The ridge voxels of the distance field are detected in parallel: the
+// field has a unit gradient everywhere but on the medial axis, where the
+// central differences of the two sides cancel, so a voxel is a ridge when
+// its gradient norm is below ridge_threshold. The inside is then thinned
+// topologically: the voxels are visited by increasing distance and removed
+// while they are simple, until a pass removes nothing. The ridge voxels
+// left with a single neighbour are the tips of the branches and are kept,
+// so the result is a centered curve skeleton with the topology of the
+// inside. Edges link the 26-adjacent nodes, but for the diagonal steps that
+// go around a node, so that the skeleton has no small triangles.
+inline bool extract_medial_axis(SDF & sdf, Eigen::MatrixXd & vertices, Eigen::MatrixXi & edges, Eigen::VectorXd & radii,
+                                double ridge_threshold = 0.7)
+{
+    const Eigen::Tensor<double, 3> & grid = sdf.get_SDF();
+    const int nx = grid.dimension(0), ny = grid.dimension(1), nz = grid.dimension(2);
+    const double grid_size = sdf.get_grid_size();
+    const long int stride_y = nx, stride_z = long(nx) * ny;
+    const double * values = grid.data();
+
+    // inside and ridge voxels, candidates in each slab
+    std::vector< uint8_t > inside(grid.size(), 0), ridge(grid.size(), 0);
+    std::vector< std::vector< std::pair<double, long int> > > slabs(nz);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int z = 0; z < nz; ++z)
+        for (int y = 0; y < ny; ++y)
+            for (int x = 0; x < nx; ++x) {
+                const long int i = x + y * stride_y + z * stride_z;
+                if (values[i] <= 0)
+                    continue;
+                inside[i] = 1;
+                slabs[z].push_back(std::make_pair(values[i], i));
+
+                if (x == 0 || y == 0 || z == 0 || x == nx - 1 || y == ny - 1 || z == nz - 1 || values[i] < grid_size)
+                    continue;
+                const Eigen::Vector3d gradient(values[i + 1] - values[i - 1],
+                                               values[i + stride_y] - values[i - stride_y],
+                                               values[i + stride_z] - values[i - stride_z]);
+                ridge[i] = gradient.norm() / (2 * grid_size) < ridge_threshold;
+            }
+
+    std::vector< std::pair<double, long int> > candidates;
+    for (int z = 0; z < nz; ++z)
+        candidates.insert(candidates.end(), slabs[z].begin(), slabs[z].end());
+    std::sort(candidates.begin(), candidates.end());
+
+    // thinning, sequential so that every removal sees the previous ones
+    bool neighbourhood[27];
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (long int c = 0; c < candidates.size(); ++c) {
+            const long int i = candidates[c].second;
+            if (!inside[i])
+                continue;
+            const int x = i % nx, y = (i / nx) % ny, z = i / stride_z;
+
+            int number_of_neighbours = 0;
+            for (int dz = -1; dz <= 1; ++dz)
+                for (int dy = -1; dy <= 1; ++dy)
+                    for (int dx = -1; dx <= 1; ++dx) {
+                        const int u = x + dx, v = y + dy, w = z + dz;
+                        const bool occupied = u >= 0 && v >= 0 && w >= 0 && u < nx && v < ny && w < nz &&
+                                              inside[u + v * stride_y + w * stride_z];
+                        neighbourhood[neighbourhood_index(dx, dy, dz)] = occupied;
+                        number_of_neighbours += occupied;
+                    }
+            number_of_neighbours -= 1;
+
+            if (ridge[i] && number_of_neighbours <= 1)
+                continue;
+            if (is_simple(neighbourhood)) {
+                inside[i] = 0;
+                changed = true;
+            }
+        }
+    }
+
+    // graph of the remaining voxels
+    std::vector< long int > nodes;
+    for (long int c = 0; c < candidates.size(); ++c)
+        if (inside[candidates[c].second])
+            nodes.push_back(candidates[c].second);
+    std::sort(nodes.begin(), nodes.end());
+
+    vertices.resize(3, nodes.size());
+    radii.resize(nodes.size());
+    std::vector< Eigen::Vector2i > edges_vector;
+    const Eigen::Matrix3d rotation = sdf.get_rotation();
+    const Eigen::Vector3d source = sdf.get_source();
+
+    for (int n = 0; n < nodes.size(); ++n) {
+        const long int i = nodes[n];
+        const int x = i % nx, y = (i / nx) % ny, z = i / stride_z;
+        vertices.col(n) = rotation * (Eigen::Vector3d(x, y, z) * grid_size + source);
+        radii(n) = values[i];
+
+        // half of the 26 neighbourhood, so that each edge is added once
+        for (int dz = 0; dz <= 1; ++dz)
+            for (int dy = -1; dy <= 1; ++dy)
+                for (int dx = -1; dx <= 1; ++dx) {
+                    if (neighbourhood_index(dx, dy, dz) <= 13)
+                        continue;
+                    const int u = x + dx, v = y + dy, w = z + dz;
+                    if (u < 0 || v < 0 || u >= nx || v >= ny || w >= nz)
+                        continue;
+                    const long int j = u + v * stride_y + w * stride_z;
+                    if (!inside[j])
+                        continue;
+
+                    // a diagonal step is dropped when a node lies on a shorter path of unit steps
+                    bool shortcut = false;
+                    for (int ez = std::min(0, dz); ez <= std::max(0, dz) && !shortcut; ++ez)
+                        for (int ey = std::min(0, dy); ey <= std::max(0, dy) && !shortcut; ++ey)
+                            for (int ex = std::min(0, dx); ex <= std::max(0, dx) && !shortcut; ++ex) {
+                                if ((ex == 0 && ey == 0 && ez == 0) || (ex == dx && ey == dy && ez == dz))
+                                    continue;
+                                const int a = x + ex, b = y + ey, c = z + ez;
+                                shortcut = a >= 0 && b >= 0 && a < nx && b < ny && c < nz && inside[a + b * stride_y + c * stride_z];
+                            }
+                    if (shortcut)
+                        continue;
+
+                    const int m = std::lower_bound(nodes.begin(), nodes.end(), j) - nodes.begin();
+                    edges_vector.push_back(Eigen::Vector2i(n, m));
+                }
+    }
+
+    edges.resize(2, edges_vector.size());
+    for (int i = 0; i < edges_vector.size(); i++)
+        edges.col(i) = edges_vector[i];
+
+    return true;
+};
+
+#endif
@@ -14,13 +14,21 @@
 #include <string>
 #include <iostream>
 #include <sstream>
+#include <memory>
+#include <algorithm>
+#include <cmath>
 #include <fstream>
+#include <iomanip>
 
 #include "EigenTools/getMinMax.h"
+#include "EigenTools/getPrincipalAxes.h"
 #include "EigenTools/nanoflannWrapper.h"
 #include "sgn.h"
 #include "IO/writePNG.h"
 #include "IO/process_folder.h"
+#include "IO/writePLYStream.h"
+#include "bitGrid.h"
+#include "gridStatistics.h"
 
 // polyscope wrapper
 class OccupancyGrid
@@ -32,42 +40,69 @@ class OccupancyGrid
         double bounding_box_scale_;
         Eigen::Tensor<bool, 3> occupancy_grid_;
         double grid_size_;
-        Eigen::Vector3d source_;
+        Eigen::Vector3d source_;            // origin of the grid, expressed in the grid frame
+        Eigen::Matrix3d rotation_;          // grid frame to world frame
+        std::shared_ptr<nanoflann_wrapper> tree_;
+        bool oriented_bounding_box_;
+        bool flood_fill_;                   // interior from an exterior flood fill instead of the normals
+        Eigen::Tensor<bool, 3> shell_;      // voxels crossed by the surface, in flood fill mode
+        double shell_radius_;               // distance to the closest point below which a voxel is in the shell
+        bool seed_faces_[6];                // faces of the grid (-x, +x, -y, +y, -z, +z) known to be exterior
 
     public:
 
-        OccupancyGrid(Eigen::MatrixXd & vertices, Eigen::MatrixXd & normals, int grid_resolution, double bounding_box_scale)
+        OccupancyGrid(Eigen::MatrixXd & vertices, Eigen::MatrixXd & normals, int grid_resolution, double bounding_box_scale, bool oriented_bounding_box = false, bool flood_fill = false)
         {
           // store variables in private variables
             vertices_ = vertices;
             normals_ = normals;
             grid_resolution_ = grid_resolution;
             bounding_box_scale_ = bounding_box_scale;
+            oriented_bounding_box_ = oriented_bounding_box;
+            flood_fill_ = flood_fill;
 
             // create the occupancy grid
             init();
         }
 
+        // compute only the voxels of the world-space box [roi_min, roi_max], with a given leaf size;
+        // the flood fill needs at least one face of the roi outside the bounding box of the points
+        OccupancyGrid(Eigen::MatrixXd & vertices, Eigen::MatrixXd & normals, Eigen::Vector3d roi_min, Eigen::Vector3d roi_max, double leaf_size, bool flood_fill = false)
+        {
+            vertices_ = vertices;
+            normals_ = normals;
+            oriented_bounding_box_ = false;
+            flood_fill_ = flood_fill;
+
+            init(roi_min, roi_max, leaf_size);
+        }
+
         // destructor
         ~OccupancyGrid()
         {
         }
 
         //accessors
-        inline Eigen::Tensor<bool, 3> get_occupancy_grid(){return occupancy_grid_;};
+        inline const Eigen::Tensor<bool, 3> & get_occupancy_grid(){return occupancy_grid_;};
         inline double get_grid_size(){return grid_size_;};
         inline Eigen::Vector3d get_source(){return source_;};
+        inline Eigen::Matrix3d get_rotation(){return rotation_;};
+        inline BitGrid get_bit_grid(){return BitGrid(occupancy_grid_);};
+        inline GridStatistics get_statistics(){return compute_statistics(get_bit_grid(), grid_size_, source_, rotation_);};
 
         // Class functions
 
         // create the occupancy grid
         void init() {
+            // the grid is aligned with the principal axes of the points, or with the world axes
+            rotation_ = Eigen::Matrix3d::Identity();
+            if (oriented_bounding_box_)
+                getPrincipalAxes(vertices_, rotation_);
+
             Eigen::Vector3d min_point, max_point;
-            getMinMax(vertices_, min_point, max_point);
+            getMinMax(rotation_.transpose() * vertices_, min_point, max_point);
 
-            //double bounding_box_size = (max_point - min_point).norm() * bounding_box_scale;
-            double bounding_box_size = (max_point - min_point).maxCoeff() * bounding_box_scale_; // diagonal versus max direction
-            double leaf_size = bounding_box_size/(grid_resolution_-1);
+            double leaf_size = getLeafSize(min_point, max_point, grid_resolution_, bounding_box_scale_);
             double inv_leaf_size = 1.0/leaf_size;
 
             Eigen::Vector3i min_box, max_box, number_of_bins;
@@ -75,37 +110,306 @@ class OccupancyGrid
             max_box << floor(max_point(0)*inv_leaf_size), floor(max_point(1)*inv_leaf_size) , floor(max_point(2)*inv_leaf_size); 
             number_of_bins << max_box(0) - min_box(0) + 1, max_box(1) - min_box(1) + 1, max_box(2) - min_box(2) + 1;
             
+            grid_size_ = leaf_size;
+            source_ = min_point;
+
+            // the grid holds all the points, every face is exterior
+            std::fill(seed_faces_, seed_faces_ + 6, true);
+
+            compute_grid(number_of_bins);
+        }
+
+        // voxelize the world-space box [roi_min, roi_max] only, the points outside still contribute to the values
+        void init(const Eigen::Vector3d & roi_min, const Eigen::Vector3d & roi_max, double leaf_size) {
+            Eigen::Vector3i number_of_bins;
+            for (int i=0; i<3; i++)
+                number_of_bins(i) = std::max(1, int(floor((roi_max(i) - roi_min(i)) / leaf_size)) + 1);
+
+            rotation_ = Eigen::Matrix3d::Identity();
+            grid_size_ = leaf_size;
+            source_ = roi_min;
+            grid_resolution_ = number_of_bins.maxCoeff();
+            bounding_box_scale_ = 1;
+
+            // only the faces of the roi beyond the bounding box of the points are
+            // exterior, the others may cut through the solid
+            Eigen::Vector3d min_point, max_point;
+            getMinMax(vertices_, min_point, max_point);
+            bool any_seed = false;
+            for (int i=0; i<3; i++) {
+                seed_faces_[2*i] = source_(i) <= min_point(i);
+                seed_faces_[2*i+1] = source_(i) + (number_of_bins(i) - 1) * grid_size_ >= max_point(i);
+                any_seed = any_seed || seed_faces_[2*i] || seed_faces_[2*i+1];
+            }
+            if (flood_fill_ && !any_seed) {
+                std::cout << "Error: the roi is inside the bounding box of the points, no exterior to flood fill from: the normals are used instead\n";
+                flood_fill_ = false;
+            }
+
+            compute_grid(number_of_bins);
+        }
+
+        // fill the grid from grid_size_, source_ and rotation_
+        void compute_grid(const Eigen::Vector3i & number_of_bins) {
             occupancy_grid_.resize(number_of_bins(0), number_of_bins(1), number_of_bins(2));
-              
-            nanoflann_wrapper tree(vertices_);
+            if (flood_fill_)
+                shell_.resize(number_of_bins(0), number_of_bins(1), number_of_bins(2));
+
+            tree_ = std::make_shared<nanoflann_wrapper>(vertices_);
+            if (flood_fill_)
+                shell_radius_ = std::sqrt(0.75) * grid_size_ + sample_spacing();
+
             for (int x = 0; x < number_of_bins(0); ++x)
                 for (int y = 0; y < number_of_bins(1); ++y)
                 {
                     #pragma omp parallel for
                     for (int z = 0; z < number_of_bins(2); ++z)
+                        compute_voxel(x, y, z);
+                }
+
+            if (flood_fill_)
+                fill_interior();
+        }
+
+        // Mean distance from a point to its nearest neighbour. In flood fill
+        // mode a voxel is in the shell when its closest point is within half a
+        // voxel diagonal plus this spacing: a surface crossing the voxel passes
+        // within half a diagonal of its center and, as long as every point of
+        // the surface has a sample within the spacing (a fairly even sampling),
+        // a sample lies within the spacing of it. Sparser regions can leak
+        // into the interior.
+        inline double sample_spacing() {
+            if (vertices_.cols() < 2)
+                return 0;
+            Eigen::MatrixXi neighbours;
+            tree_->return_k_closest_points(vertices_, 2, neighbours);
+            double spacing = 0;
+            #pragma omp parallel for reduction(+:spacing)
+            for (long int i = 0; i < vertices_.cols(); ++i)
+                spacing += (vertices_.col(neighbours(1, i)) - vertices_.col(i)).norm();
+            return spacing / vertices_.cols();
+        }
+
+        // value of one voxel from its closest point
+        inline void compute_voxel(int x, int y, int z) {
+            std::vector< int > closest_point;
+            Eigen::Vector3d point;
+            point << x, y, z;
+            point *= grid_size_;
+            point += source_;
+            point = rotation_ * point;
+            if (flood_fill_) {
+                std::vector<double> squared_distance;
+                tree_->return_k_closest_points(point, 1, closest_point, squared_distance);
+                shell_(x, y, z) = squared_distance[0] <= shell_radius_ * shell_radius_;
+                return;
+            }
+
+            closest_point = tree_->return_k_closest_points(point, 1);
+
+            /* produce the outer shell only remove the next line
+            if ( (point - vertices.row(closest_point[0]).transpose()).norm() < leaf_size(0)*2 )
+                grid(x, y, z) = true;
+            else
+                grid(x, y, z) = false;
+            */
+            // here is the key function
+            occupancy_grid_(x, y, z) = is_positive( ( vertices_.col(closest_point[0]) - point ).dot( normals_.col(closest_point[0]) ) );
+        }
+
+        // Update the grid after an edit of the input points: the points whose
+        // index is in removed are dropped and the added ones are appended. A
+        // voxel can only change if a removed point was its closest one, or if an
+        // added point is closer than its current closest one; both imply that
+        // the changed point lies within d(c) + 2h of the center c of the brick
+        // holding the voxel, where d is the distance to the closest point (which
+        // is 1-Lipschitz) and h the brick half diagonal. Only those bricks are
+        // recomputed, the extent of the grid is kept. Returns the number of
+        // recomputed bricks, or -1 without changing anything if the grid was
+        // not built from points or the edit is invalid.
+        int update(const std::vector<int> & removed, const Eigen::MatrixXd & added_vertices, const Eigen::MatrixXd & added_normals) {
+            if (!tree_) {
+                std::cout << "Error: the grid was not built from points, it cannot be updated\n";
+                return -1;
+            }
+            if (added_normals.cols() != added_vertices.cols() || (added_vertices.cols() > 0 && (added_vertices.rows() != 3 || added_normals.rows() != 3))) {
+                std::cout << "Error: the added points need a 3D position and a normal each\n";
+                return -1;
+            }
+            std::vector<bool> is_removed(vertices_.cols(), false);
+            for (int i=0; i<removed.size(); i++) {
+                if (removed[i] < 0 || removed[i] >= vertices_.cols() || is_removed[removed[i]]) {
+                    std::cout << "Error: the removed point " << removed[i] << " is out of range or repeated\n";
+                    return -1;
+                }
+                is_removed[removed[i]] = true;
+            }
+
+            const int brick_size = 8;
+            Eigen::Vector3i number_of_bins(occupancy_grid_.dimension(0), occupancy_grid_.dimension(1), occupancy_grid_.dimension(2));
+            Eigen::Vector3i number_of_bricks = (number_of_bins.array() + brick_size - 1) / brick_size;
+
+            Eigen::MatrixXd changed(3, removed.size() + added_vertices.cols());
+            for (int i=0; i<removed.size(); i++)
+                changed.col(i) = vertices_.col(removed[i]);
+            changed.rightCols(added_vertices.cols()) = added_vertices;
+
+            // bricks which can be affected, found with the old points
+            std::vector< Eigen::Vector3i > dirty_bricks;
+            #pragma omp parallel for collapse(3) schedule(dynamic)
+            for (int bx = 0; bx < number_of_bricks(0); ++bx)
+                for (int by = 0; by < number_of_bricks(1); ++by)
+                    for (int bz = 0; bz < number_of_bricks(2); ++bz)
+                    {
+                        Eigen::Vector3i first(bx, by, bz), last;
+                        first *= brick_size;
+                        last = (first.array() + brick_size).min(number_of_bins.array()) - 1;
+
+                        Eigen::Vector3d center = rotation_ * ((first + last).cast<double>() * 0.5 * grid_size_ + source_);
+                        double half_diagonal = 0.5 * grid_size_ * (last - first).cast<double>().norm();
+
+                        std::vector<int> closest_point;
+                        std::vector<double> squared_distance;
+                        tree_->return_k_closest_points(center, 1, closest_point, squared_distance);
+                        double radius = sqrt(squared_distance[0]) + 2 * half_diagonal;
+
+                        bool dirty = false;
+                        for (int i=0; i<changed.cols() && !dirty; i++)
+                            dirty = (changed.col(i) - center).squaredNorm() <= radius * radius;
+
+                        if (dirty) {
+                            #pragma omp critical
+                            dirty_bricks.push_back(first);
+                        }
+                    }
+
+            // new set of points
+            Eigen::MatrixXd vertices(3, vertices_.cols() - removed.size() + added_vertices.cols());
+            Eigen::MatrixXd normals(3, vertices.cols());
+            int kept = 0;
+            for (int i=0; i<vertices_.cols(); i++)
+                if (!is_removed[i]) {
+                    vertices.col(kept) = vertices_.col(i);
+                    normals.col(kept) = normals_.col(i);
+                    kept++;
+                }
+            vertices.rightCols(added_vertices.cols()) = added_vertices;
+            normals.rightCols(added_normals.cols()) = added_normals;
+            vertices_.swap(vertices);
+            normals_.swap(normals);
+            tree_ = std::make_shared<nanoflann_wrapper>(vertices_);
+
+            #pragma omp parallel for schedule(dynamic)
+            for (int b = 0; b < dirty_bricks.size(); ++b) {
+                Eigen::Vector3i first = dirty_bricks[b];
+                Eigen::Vector3i last = (first.array() + brick_size).min(number_of_bins.array());
+                for (int x = first(0); x < last(0); ++x)
+                    for (int y = first(1); y < last(1); ++y)
+                        for (int z = first(2); z < last(2); ++z)
+                            compute_voxel(x, y, z);
+            }
+
+            if (flood_fill_)
+                fill_interior();
+
+            return dirty_bricks.size();
+        }
+
+        // Flood fill the exterior from the faces of the grid through the
+        // voxels outside the shell; the shell and everything not reached are
+        // occupied. Only the faces known to be exterior are seeds (all of them
+        // for a grid around the points, the ones beyond the points for a roi).
+        // The fill alternates scanline sweeps along x, y and z, each sweep
+        // propagating forward then backward along every line with the lines in
+        // parallel, until a round of sweeps changes nothing. No sign is
+        // queried, so holes smaller than the shell thickness and flipped
+        // normals do not leak into the result.
+        inline void fill_interior() {
+            const int n[3] = {int(shell_.dimension(0)), int(shell_.dimension(1)), int(shell_.dimension(2))};
+            const long int stride[3] = {1, n[0], long(n[0]) * n[1]};
+            const bool * shell = shell_.data();
+
+            // exterior seeds: the free voxels on the faces of the grid
+            std::vector< char > exterior(shell_.size(), 0);
+            #pragma omp parallel for
+            for (int z = 0; z < n[2]; ++z)
+                for (int y = 0; y < n[1]; ++y)
+                    for (int x = 0; x < n[0]; ++x)
                     {
-                        std::vector< int > closest_point;
-                        Eigen::Vector3d point;
-                        point << x, y, z;
-                        point *= leaf_size;
-                        point += min_point;
-                        closest_point = tree.return_k_closest_points(point, 1);
-                        
-                        /* produce the outer shell only remove the next line
-                        if ( (point - vertices.row(closest_point[0]).transpose()).norm() < leaf_size(0)*2 )
-                            grid(x, y, z) = true;
-                        else
-                            grid(x, y, z) = false;
-                        */
-                        // here is the key function
-                        occupancy_grid_(x, y, z) = is_positive( ( vertices_.col(closest_point[0]) - point ).dot( normals_.col(closest_point[0]) ) );
+                        long int i = x + y * stride[1] + z * stride[2];
+                        bool on_face = (seed_faces_[0] && x == 0) || (seed_faces_[1] && x == n[0]-1) ||
+                                       (seed_faces_[2] && y == 0) || (seed_faces_[3] && y == n[1]-1) ||
+                                       (seed_faces_[4] && z == 0) || (seed_faces_[5] && z == n[2]-1);
+                        exterior[i] = on_face && !shell[i];
                     }
+
+            bool changed = true;
+            while (changed) {
+                changed = false;
+                for (int axis = 0; axis < 3; ++axis) {
+                    // the lines along axis are indexed by the two other coordinates
+                    const int u = (axis + 1) % 3, v = (axis + 2) % 3;
+                    bool axis_changed = false;
+
+                    #pragma omp parallel for collapse(2) reduction(||:axis_changed)
+                    for (int b = 0; b < n[v]; ++b)
+                        for (int a = 0; a < n[u]; ++a)
+                        {
+                            const long int start = a * stride[u] + b * stride[v];
+                            const long int step = stride[axis];
+                            for (int pass = 0; pass < 2; ++pass) {
+                                long int previous = pass == 0 ? start : start + (n[axis] - 1) * step;
+                                const long int direction = pass == 0 ? step : -step;
+                                for (int k = 1; k < n[axis]; ++k) {
+                                    long int i = previous + direction;
+                                    if (!exterior[i] && !shell[i] && exterior[previous]) {
+                                        exterior[i] = 1;
+                                        axis_changed = true;
+                                    }
+                                    previous = i;
+                                }
+                            }
+                        }
+
+                    changed = changed || axis_changed;
                 }
-              
-            grid_size_ = leaf_size;
-            source_ = min_point;
+            }
+
+            bool * occupancy = occupancy_grid_.data();
+            #pragma omp parallel for
+            for (long int i = 0; i < long(shell_.size()); ++i)
+                occupancy[i] = !exterior[i];
         }
 
+        // binary morphology on the bit-packed grid (see bitGrid.h), the voxels outside the grid are empty
+        inline void dilate(int radius, StructuringElement element = CONNECTIVITY_26) {
+            BitGrid grid(occupancy_grid_);
+            ::dilate(grid, grid, element, radius);
+            grid.to_tensor(occupancy_grid_);
+        };
+
+        inline void erode(int radius, StructuringElement element = CONNECTIVITY_26) {
+            BitGrid grid(occupancy_grid_);
+            ::erode(grid, grid, element, radius);
+            grid.to_tensor(occupancy_grid_);
+        };
+
+        // erosion then dilation: removes the parts thinner than the structuring element
+        inline void open(int radius, StructuringElement element = CONNECTIVITY_26) {
+            BitGrid grid(occupancy_grid_);
+            ::erode(grid, grid, element, radius);
+            ::dilate(grid, grid, element, radius);
+            grid.to_tensor(occupancy_grid_);
+        };
+
+        // dilation then erosion: fills the gaps thinner than the structuring element
+        inline void close(int radius, StructuringElement element = CONNECTIVITY_26) {
+            BitGrid grid(occupancy_grid_);
+            ::dilate(grid, grid, element, radius);
+            ::erode(grid, grid, element, radius);
+            grid.to_tensor(occupancy_grid_);
+        };
+
         // build a graph from the occupied space (there is no garanty of connectivity)
         inline bool generate_graph(Eigen::MatrixXd & vertices, Eigen::MatrixXi & edges) {
 
@@ -180,7 +484,7 @@ class OccupancyGrid
             
             vertices.resize(3, vertices_vector.size());
             for (int i=0; i< vertices_vector.size(); i++)
-                vertices.col(i) = vertices_vector[i];
+                vertices.col(i) = rotation_ * vertices_vector[i];
 
             edges.resize(2, edges_vector.size());
             for (int i=0; i< edges_vector.size(); i++)
@@ -281,7 +585,7 @@ class OccupancyGrid
             
             vertices.resize(3, vertices_vector.size());
             for (int i=0; i< vertices_vector.size(); i++)
-                vertices.col(i) = vertices_vector[i];
+                vertices.col(i) = rotation_ * vertices_vector[i];
 
             faces.resize(3, faces_vector.size());
             for (int i=0; i< faces_vector.size(); i++)
@@ -290,6 +594,53 @@ class OccupancyGrid
             return true;
         };
 
+        // stream the cubes of generate_mesh into a binary ply file, without building the mesh in memory
+        inline bool write_mesh_to_ply(std::string filename) {
+            static const float corners[8][3] = { { 0.5, 0.5, 0.5}, { 0.5, 0.5,-0.5}, { 0.5,-0.5, 0.5}, { 0.5,-0.5,-0.5},
+                                                 {-0.5, 0.5, 0.5}, {-0.5, 0.5,-0.5}, {-0.5,-0.5, 0.5}, {-0.5,-0.5,-0.5} };
+            static const int faces[12][3] = { {0, 3, 1}, {0, 2, 3}, {0, 1, 5}, {0, 5, 4}, {4, 5, 7}, {4, 7, 6},
+                                              {2, 6, 7}, {2, 7, 3}, {1, 3, 7}, {1, 7, 5}, {0, 4, 2}, {2, 4, 6} };
+
+            // one index per occupied voxel, in the same order as generate_mesh
+            std::vector< Eigen::Vector3i > occupied;
+            for (int x = 0; x < occupancy_grid_.dimension(0); ++x)
+                for (int y = 0; y < occupancy_grid_.dimension(1); ++y)
+                    for (int z = 0; z < occupancy_grid_.dimension(2); ++z)
+                        if (occupancy_grid_(x, y, z) == 1)
+                            occupied.push_back(Eigen::Vector3i(x, y, z));
+
+            if (occupied.empty()) {
+                std::cout << "Error: the occupancy grid is empty\n";
+                return false;
+            }
+
+            PLYVertexGenerator vertex_generator = [&](size_t i, float3 & position, float3 & normal, uchar3 & rgb) {
+                const Eigen::Vector3i & voxel = occupied[i/8];
+                const float * corner = corners[i%8];
+                Eigen::Vector3d local_position(voxel(0) + corner[0], voxel(1) + corner[1], voxel(2) + corner[2]);
+                Eigen::Vector3d world_position = rotation_ * (local_position * grid_size_ + source_);
+                position.x = world_position(0);
+                position.y = world_position(1);
+                position.z = world_position(2);
+            };
+
+            PLYFaceGenerator face_generator = [&](size_t i, uint3 & face) {
+                uint32_t offset = (i/12) * 8;
+                face.x = faces[i%12][0] + offset;
+                face.y = faces[i%12][1] + offset;
+                face.z = faces[i%12][2] + offset;
+            };
+
+            try {
+                writePLY_stream(filename, occupied.size()*8, occupied.size()*12, false, false, vertex_generator, face_generator);
+            } catch (const std::exception & e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+                return false;
+            }
+
+            return true;
+        };
+
         inline bool make_cube(Eigen::Vector3d centroid, double size, std::vector< Eigen::Vector3d > & vertices_vector, std::vector< Eigen::Vector3i > & faces_vector) {
           
             Eigen::Vector3i vertices_offset = Eigen::Vector3i::Constant(vertices_vector.size());
@@ -4,8 +4,8 @@
 *   07/02/2020
 */
 
-#ifndef OCCUPANCY_GRID_H
-#define OCCUPANCY_GRID_H
+#ifndef OCCUPANCY_GRID_WITH_COLOR_H
+#define OCCUPANCY_GRID_WITH_COLOR_H
 
 #include <Eigen/Core>
 #include <unsupported/Eigen/CXX11/Tensor>
@@ -18,10 +18,12 @@
 #include <iomanip>
 
 #include "EigenTools/getMinMax.h"
+#include "EigenTools/getPrincipalAxes.h"
 #include "EigenTools/nanoflannWrapper.h"
 #include "sgn.h"
 #include "IO/writePNG.h"
 #include "IO/process_folder.h"
+#include "IO/writePLYStream.h"
 #include "colorPalette.h"
 
 // polyscope wrapper
@@ -38,23 +40,26 @@ class OccupancyGridWithColor
         Eigen::Tensor<double, 3> G_;
         Eigen::Tensor<double, 3> B_;
         double grid_size_;
-        Eigen::Vector3d source_;
+        Eigen::Vector3d source_;            // origin of the grid, expressed in the grid frame
+        Eigen::Matrix3d rotation_;          // grid frame to world frame
+        bool oriented_bounding_box_;
 
     public:
 
-        OccupancyGridWithColor(Eigen::MatrixXd & vertices, Eigen::MatrixXd & normals, int grid_resolution, double bounding_box_scale)
+        OccupancyGridWithColor(Eigen::MatrixXd & vertices, Eigen::MatrixXd & normals, int grid_resolution, double bounding_box_scale, bool oriented_bounding_box = false)
         {
           // store variables in private variables
             vertices_ = vertices;
             normals_ = normals;
             grid_resolution_ = grid_resolution;
             bounding_box_scale_ = bounding_box_scale;
+            oriented_bounding_box_ = oriented_bounding_box;
 
             // create the occupancy grid
             init();
         }
 
-        OccupancyGridWithColor(Eigen::MatrixXd & vertices, Eigen::MatrixXd & normals, Eigen::MatrixXd & RGB, int grid_resolution, double bounding_box_scale)
+        OccupancyGridWithColor(Eigen::MatrixXd & vertices, Eigen::MatrixXd & normals, Eigen::MatrixXd & RGB, int grid_resolution, double bounding_box_scale, bool oriented_bounding_box = false)
         {
           // store variables in private variables
             vertices_ = vertices;
@@ -62,6 +67,7 @@ class OccupancyGridWithColor
             RGB_ =  RGB;
             grid_resolution_ = grid_resolution;
             bounding_box_scale_ = bounding_box_scale;
+            oriented_bounding_box_ = oriented_bounding_box;
 
             // create the occupancy grid
             init();
@@ -73,20 +79,24 @@ class OccupancyGridWithColor
         }
 
         //accessors
-        inline Eigen::Tensor<bool, 3> get_occupancy_grid(){return occupancy_grid_;};
+        inline const Eigen::Tensor<bool, 3> & get_occupancy_grid(){return occupancy_grid_;};
         inline double get_grid_size(){return grid_size_;};
         inline Eigen::Vector3d get_source(){return source_;};
+        inline Eigen::Matrix3d get_rotation(){return rotation_;};
 
         // Class functions
 
         // create the occupancy grid
         void init() {
+            // the grid is aligned with the principal axes of the points, or with the world axes
+            rotation_ = Eigen::Matrix3d::Identity();
+            if (oriented_bounding_box_)
+                getPrincipalAxes(vertices_, rotation_);
+
             Eigen::Vector3d min_point, max_point;
-            getMinMax(vertices_, min_point, max_point);
+            getMinMax(rotation_.transpose() * vertices_, min_point, max_point);
 
-            //double bounding_box_size = (max_point - min_point).norm() * bounding_box_scale;
-            double bounding_box_size = (max_point - min_point).maxCoeff() * bounding_box_scale_; // diagonal versus max direction
-            double leaf_size = bounding_box_size/(grid_resolution_-1);
+            double leaf_size = getLeafSize(min_point, max_point, grid_resolution_, bounding_box_scale_);
             double inv_leaf_size = 1.0/leaf_size;
 
             Eigen::Vector3i min_box, max_box, number_of_bins;
@@ -111,6 +121,7 @@ class OccupancyGridWithColor
                         point << x, y, z;
                         point *= leaf_size;
                         point += min_point;
+                        point = rotation_ * point;
                         closest_point = tree.return_k_closest_points(point, 1);
                         
                         /* produce the outer shell only remove the next line
@@ -205,7 +216,7 @@ class OccupancyGridWithColor
             
             vertices.resize(3, vertices_vector.size());
             for (int i=0; i< vertices_vector.size(); i++)
-                vertices.col(i) = vertices_vector[i];
+                vertices.col(i) = rotation_ * vertices_vector[i];
 
             edges.resize(2, edges_vector.size());
             for (int i=0; i< edges_vector.size(); i++)
@@ -312,7 +323,7 @@ class OccupancyGridWithColor
             
             vertices.resize(3, vertices_vector.size());
             for (int i=0; i< vertices_vector.size(); i++)
-                vertices.col(i) = vertices_vector[i];
+                vertices.col(i) = rotation_ * vertices_vector[i];
             
             colors.resize(3, color_vector.size());
             for (int i=0; i< color_vector.size(); i++)
@@ -325,6 +336,56 @@ class OccupancyGridWithColor
             return true;
         };
 
+        // stream the cubes of generate_mesh into a binary ply file, without building the mesh in memory
+        inline bool write_mesh_to_ply(std::string filename) {
+            static const float corners[8][3] = { { 0.5, 0.5, 0.5}, { 0.5, 0.5,-0.5}, { 0.5,-0.5, 0.5}, { 0.5,-0.5,-0.5},
+                                                 {-0.5, 0.5, 0.5}, {-0.5, 0.5,-0.5}, {-0.5,-0.5, 0.5}, {-0.5,-0.5,-0.5} };
+            static const int faces[12][3] = { {0, 3, 1}, {0, 2, 3}, {0, 1, 5}, {0, 5, 4}, {4, 5, 7}, {4, 7, 6},
+                                              {2, 6, 7}, {2, 7, 3}, {1, 3, 7}, {1, 7, 5}, {0, 4, 2}, {2, 4, 6} };
+
+            // one index per occupied voxel, in the same order as generate_mesh
+            std::vector< Eigen::Vector3i > occupied;
+            for (int x = 0; x < occupancy_grid_.dimension(0); ++x)
+                for (int y = 0; y < occupancy_grid_.dimension(1); ++y)
+                    for (int z = 0; z < occupancy_grid_.dimension(2); ++z)
+                        if (occupancy_grid_(x, y, z) == 1)
+                            occupied.push_back(Eigen::Vector3i(x, y, z));
+
+            if (occupied.empty()) {
+                std::cout << "Error: the occupancy grid is empty\n";
+                return false;
+            }
+
+            PLYVertexGenerator vertex_generator = [&](size_t i, float3 & position, float3 & normal, uchar3 & rgb) {
+                const Eigen::Vector3i & voxel = occupied[i/8];
+                const float * corner = corners[i%8];
+                Eigen::Vector3d local_position(voxel(0) + corner[0], voxel(1) + corner[1], voxel(2) + corner[2]);
+                Eigen::Vector3d world_position = rotation_ * (local_position * grid_size_ + source_);
+                position.x = world_position(0);
+                position.y = world_position(1);
+                position.z = world_position(2);
+                rgb.r = std::min(255.0, R_(voxel(0), voxel(1), voxel(2)) * 256);
+                rgb.g = std::min(255.0, G_(voxel(0), voxel(1), voxel(2)) * 256);
+                rgb.b = std::min(255.0, B_(voxel(0), voxel(1), voxel(2)) * 256);
+            };
+
+            PLYFaceGenerator face_generator = [&](size_t i, uint3 & face) {
+                uint32_t offset = (i/12) * 8;
+                face.x = faces[i%12][0] + offset;
+                face.y = faces[i%12][1] + offset;
+                face.z = faces[i%12][2] + offset;
+            };
+
+            try {
+                writePLY_stream(filename, occupied.size()*8, occupied.size()*12, false, true, vertex_generator, face_generator);
+            } catch (const std::exception & e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+                return false;
+            }
+
+            return true;
+        };
+
         inline bool make_cube(
             Eigen::Vector3d centroid, 
             Eigen::Vector3d color, 
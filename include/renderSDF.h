@@ -0,0 +1,166 @@
+/*
+*   headless sphere tracing of a SDF
+*   by R. Falque
+*   18/10/2026
+*/
+
+#ifndef RENDER_SDF_H
+#define RENDER_SDF_H
+
+#include <Eigen/Core>
+
+#include <string>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <iostream>
+
+#include "sdf.h"
+#include "IO/writePNG.h"
+
+// Render the zero level set of a SDF seen from an orbit camera looking at
+// the center of the grid (azimuth around and elevation above the world z
+// axis, in radians). The rays start where they enter the grid box and step
+// by |sdf|, the distance to the closest sample whatever its sign; a hit is a
+// crossing from outside (negative) to a value close to zero, so the sign
+// flips far from the surface, where the closest normals disagree, are
+// stepped over instead of being shaded. The image is cut in 16x16 tiles
+// spread over the threads, each tile row is traced by packets of 8 rays
+// sharing one trilinear lookup per step (SDF::sample_block), and the hits
+// are shaded with the normal -grad and a headlight. Row 0 of R, G, B is the
+// bottom of the image, as written by writePNG.
+inline bool render_SDF(SDF & sdf, int width, int height, double azimuth, double elevation,
+                       Eigen::MatrixXd & R, Eigen::MatrixXd & G, Eigen::MatrixXd & B)
+{
+    const int tile_size = 16;
+    const int packet_size = 8;
+    const int max_steps = 512;
+    const double field_of_view = 40 * M_PI / 180;
+    const Eigen::Vector3d surface_color(0.75, 0.8, 0.9);
+    const double background = 1.0;
+
+    // grid box in its own frame
+    const Eigen::Tensor<double, 3> & grid = sdf.get_SDF();
+    const double grid_size = sdf.get_grid_size();
+    const Eigen::Matrix3d rotation = sdf.get_rotation();
+    const Eigen::Vector3d box_min = sdf.get_source();
+    const Eigen::Vector3d box_max = box_min + grid_size * Eigen::Vector3d(grid.dimension(0) - 1, grid.dimension(1) - 1, grid.dimension(2) - 1);
+    const double hit_threshold = 0.05 * grid_size;
+    const double min_step = 0.1 * grid_size;
+
+    // orbit camera
+    const Eigen::Vector3d center = rotation * (box_min + box_max) / 2;
+    const double radius = (box_max - box_min).norm() / 2;
+    const Eigen::Vector3d eye = center + radius / std::sin(field_of_view / 2) *
+        Eigen::Vector3d(std::cos(elevation) * std::cos(azimuth), std::cos(elevation) * std::sin(azimuth), std::sin(elevation));
+    const Eigen::Vector3d forward = (center - eye).normalized();
+    Eigen::Vector3d right = forward.cross(Eigen::Vector3d::UnitZ());
+    if (right.norm() < 1e-6)
+        right = forward.cross(Eigen::Vector3d::UnitY());
+    right.normalize();
+    const Eigen::Vector3d up = right.cross(forward);
+    const double half_height = std::tan(field_of_view / 2);
+    const double half_width = half_height * width / height;
+    const Eigen::Vector3d eye_in_grid = rotation.transpose() * eye;
+
+    R.setConstant(height, width, background);
+    G.setConstant(height, width, background);
+    B.setConstant(height, width, background);
+
+    const int tiles_x = (width + tile_size - 1) / tile_size;
+    const int tiles_y = (height + tile_size - 1) / tile_size;
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int tile = 0; tile < tiles_x * tiles_y; ++tile) {
+        const int first_x = (tile % tiles_x) * tile_size;
+        const int first_y = (tile / tiles_x) * tile_size;
+
+        for (int row = first_y; row < std::min(first_y + tile_size, height); ++row)
+            for (int packet = first_x; packet < std::min(first_x + tile_size, width); packet += packet_size)
+            {
+                const int count = std::min(packet_size, width - packet);
+                double directions[3 * packet_size], points[3 * packet_size], distances[packet_size], gradients[3 * packet_size];
+                double t[packet_size], t_exit[packet_size];
+                bool active[packet_size], hit[packet_size];
+
+                // rays, clipped to the grid box with the slab test in the grid frame
+                for (int l = 0; l < packet_size; ++l) {
+                    const int column = packet + std::min(l, count - 1);
+                    const double u = ((column + 0.5) / width * 2 - 1) * half_width;
+                    const double v = ((row + 0.5) / height * 2 - 1) * half_height;
+                    Eigen::Map<Eigen::Vector3d> direction(directions + 3*l);
+                    direction = (forward + u * right + v * up).normalized();
+
+                    const Eigen::Vector3d direction_in_grid = rotation.transpose() * direction;
+                    double t_min = 0, t_max = std::numeric_limits<double>::max();
+                    for (int i = 0; i < 3; ++i) {
+                        double inv = 1.0 / direction_in_grid(i);
+                        double t0 = (box_min(i) - eye_in_grid(i)) * inv;
+                        double t1 = (box_max(i) - eye_in_grid(i)) * inv;
+                        t_min = std::max(t_min, std::min(t0, t1));
+                        t_max = std::min(t_max, std::max(t0, t1));
+                    }
+                    t[l] = t_min;
+                    t_exit[l] = t_max;
+                    active[l] = l < count && t_min <= t_max;
+                    hit[l] = false;
+                }
+
+                // sphere tracing, one packed lookup per step
+                for (int step = 0; step < max_steps; ++step) {
+                    bool any_active = false;
+                    for (int l = 0; l < packet_size; ++l) {
+                        any_active |= active[l];
+                        for (int i = 0; i < 3; ++i)
+                            points[3*l + i] = eye(i) + t[l] * directions[3*l + i];
+                    }
+                    if (!any_active)
+                        break;
+
+                    sdf.sample_block(points, packet_size, distances, NULL);
+
+                    for (int l = 0; l < packet_size; ++l) {
+                        if (!active[l])
+                            continue;
+                        if (distances[l] > -hit_threshold && distances[l] < grid_size) {
+                            hit[l] = true;
+                            active[l] = false;
+                        } else {
+                            t[l] += std::max(std::abs(distances[l]), min_step);
+                            active[l] = t[l] <= t_exit[l];
+                        }
+                    }
+                }
+
+                // shading
+                sdf.sample_block(points, packet_size, distances, gradients);
+                for (int l = 0; l < count; ++l) {
+                    if (!hit[l])
+                        continue;
+                    Eigen::Vector3d normal = -Eigen::Map<Eigen::Vector3d>(gradients + 3*l);
+                    if (normal.norm() > 0)
+                        normal.normalize();
+                    double lambert = std::max(0.0, -normal.dot(Eigen::Map<Eigen::Vector3d>(directions + 3*l)));
+                    Eigen::Vector3d color = surface_color * (0.15 + 0.85 * lambert);
+                    R(row, packet + l) = color(0);
+                    G(row, packet + l) = color(1);
+                    B(row, packet + l) = color(2);
+                }
+            }
+    }
+
+    return true;
+};
+
+inline bool render_SDF_to_png(SDF & sdf, std::string png_file, int width = 512, int height = 512, double azimuth = M_PI / 4, double elevation = M_PI / 8)
+{
+    Eigen::MatrixXd R, G, B;
+    render_SDF(sdf, width, height, azimuth, elevation, R, G, B);
+    writePNG(R, G, B, png_file);
+
+    std::cout << "Progress: SDF preview written in :" << png_file << std::endl;
+
+    return true;
+};
+
+#endif
@@ -14,12 +14,22 @@
 #include <string>
 #include <iostream>
 #include <sstream>
+#include <memory>
+#include <iomanip>
+#include <algorithm>
+#include <limits>
 
 #include "EigenTools/getMinMax.h"
+#include "EigenTools/getPrincipalAxes.h"
 #include "EigenTools/nanoflannWrapper.h"
+#include "mesh/closestPointOnTriangle.h"
 #include "sgn.h"
 #include "IO/writePNG.h"
 #include "IO/process_folder.h"
+#include "gridStatistics.h"
+
+// operations of SDF::combine, with the SDF positive inside
+enum CSGOperation {CSG_UNION, CSG_INTERSECTION, CSG_DIFFERENCE, CSG_SMOOTH_UNION};
 
 // polyscope wrapper
 class SDF
@@ -31,37 +41,115 @@ class SDF
         double bounding_box_scale_;
         Eigen::Tensor<double, 3> SDF_;
         double grid_size_;
-        Eigen::Vector3d source_;
+        Eigen::Vector3d source_;            // origin of the grid, expressed in the grid frame
+        Eigen::Matrix3d rotation_;          // grid frame to world frame
+        std::shared_ptr<nanoflann_wrapper> tree_;
+        bool oriented_bounding_box_;
+        Eigen::Matrix<float, 3, Eigen::Dynamic> gradients_;    // optional, world frame, one column per voxel in the tensor order
+        bool store_closest_points_;
+        Eigen::Tensor<int, 3> closest_points_;                  // optional, index of the closest input point of each voxel
+        Eigen::Tensor<float, 3> weights_;                       // optional, weights of the depth maps integrated in each voxel
 
     public:
 
-        SDF(Eigen::MatrixXd & vertices, Eigen::MatrixXd & normals, int grid_resolution, double bounding_box_scale)
+        SDF(Eigen::MatrixXd & vertices, Eigen::MatrixXd & normals, int grid_resolution, double bounding_box_scale, bool oriented_bounding_box = false, bool store_closest_points = false)
         {
             vertices_ = vertices;
             normals_ = normals;
             grid_resolution_ = grid_resolution;
             bounding_box_scale_ = bounding_box_scale;
+            oriented_bounding_box_ = oriented_bounding_box;
+            store_closest_points_ = store_closest_points;
 
             init();
         }
 
+        // compute only the voxels of the world-space box [roi_min, roi_max], with a given leaf size
+        SDF(Eigen::MatrixXd & vertices, Eigen::MatrixXd & normals, Eigen::Vector3d roi_min, Eigen::Vector3d roi_max, double leaf_size, bool store_closest_points = false)
+        {
+            vertices_ = vertices;
+            normals_ = normals;
+            oriented_bounding_box_ = false;
+            store_closest_points_ = store_closest_points;
+
+            init(roi_min, roi_max, leaf_size);
+        }
+
+        // wrap an existing grid (e.g. the result of a CSG operation), there are no points to update it from
+        SDF(const Eigen::Tensor<double, 3> & grid, double grid_size, Eigen::Vector3d source, Eigen::Matrix3d rotation = Eigen::Matrix3d::Identity())
+        {
+            SDF_ = grid;
+            grid_size_ = grid_size;
+            source_ = source;
+            rotation_ = rotation;
+            grid_resolution_ = std::max(grid.dimension(0), std::max(grid.dimension(1), grid.dimension(2)));
+            bounding_box_scale_ = 1;
+            oriented_bounding_box_ = false;
+            store_closest_points_ = false;
+        }
+
+        // empty volume over the world-space box [roi_min, roi_max], to be filled
+        // with integrate_depth; the voxels not observed yet are one voxel outside
+        SDF(Eigen::Vector3d roi_min, Eigen::Vector3d roi_max, double leaf_size)
+        {
+            Eigen::Vector3i number_of_bins;
+            for (int i=0; i<3; i++)
+                number_of_bins(i) = std::max(1, int(floor((roi_max(i) - roi_min(i)) / leaf_size)) + 1);
+
+            rotation_ = Eigen::Matrix3d::Identity();
+            grid_size_ = leaf_size;
+            source_ = roi_min;
+            grid_resolution_ = number_of_bins.maxCoeff();
+            bounding_box_scale_ = 1;
+            oriented_bounding_box_ = false;
+            store_closest_points_ = false;
+
+            SDF_.resize(number_of_bins(0), number_of_bins(1), number_of_bins(2));
+            SDF_.setConstant(-leaf_size);
+            weights_.resize(number_of_bins(0), number_of_bins(1), number_of_bins(2));
+            weights_.setZero();
+        }
+
         // destructor
         ~SDF()
         {
         }
 
         //accessors
-        inline Eigen::Tensor<double, 3> get_SDF(){return SDF_;};
+        inline const Eigen::Tensor<double, 3> & get_SDF(){return SDF_;};
         inline double get_grid_size(){return grid_size_;};
         inline Eigen::Vector3d get_source(){return source_;};
+        inline Eigen::Matrix3d get_rotation(){return rotation_;};
+        inline const Eigen::Matrix<float, 3, Eigen::Dynamic> & get_gradient_field(){return gradients_;};
+        inline const Eigen::Tensor<int, 3> & get_closest_points(){return closest_points_;};
+        inline const Eigen::Tensor<float, 3> & get_weights(){return weights_;};
+
+        // voxels above level (inside when level is 0), packed in one pass
+        inline BitGrid get_bit_grid(double level = 0) {
+            BitGrid grid(SDF_.dimension(0), SDF_.dimension(1), SDF_.dimension(2));
+            const double * data = SDF_.data();
+            #pragma omp parallel for
+            for (int z = 0; z < SDF_.dimension(2); ++z)
+                for (int y = 0; y < SDF_.dimension(1); ++y) {
+                    const double * in = data + (long(z) * SDF_.dimension(1) + y) * SDF_.dimension(0);
+                    uint64_t * out = grid.row(y, z);
+                    for (int x = 0; x < SDF_.dimension(0); ++x)
+                        out[x >> 6] |= uint64_t(in[x] > level) << (x & 63);
+                }
+            return grid;
+        };
+        inline GridStatistics get_statistics(double level = 0){return compute_statistics(get_bit_grid(level), grid_size_, source_, rotation_);};
 
         void init() {
+            // the grid is aligned with the principal axes of the points, or with the world axes
+            rotation_ = Eigen::Matrix3d::Identity();
+            if (oriented_bounding_box_)
+                getPrincipalAxes(vertices_, rotation_);
+
             Eigen::Vector3d min_point, max_point;
-            getMinMax(vertices_, min_point, max_point);
+            getMinMax(rotation_.transpose() * vertices_, min_point, max_point);
 
-            //double bounding_box_size = (max_point - min_point).norm() * bounding_box_scale;
-            double bounding_box_size = (max_point - min_point).maxCoeff() * bounding_box_scale_; // diagonal versus max direction
-            double leaf_size = bounding_box_size/(grid_resolution_-1);
+            double leaf_size = getLeafSize(min_point, max_point, grid_resolution_, bounding_box_scale_);
             double inv_leaf_size = 1.0/leaf_size;
 
             Eigen::Vector3i min_box, max_box, number_of_bins;
@@ -69,30 +157,655 @@ class SDF
             max_box << floor(max_point(0)*inv_leaf_size), floor(max_point(1)*inv_leaf_size) , floor(max_point(2)*inv_leaf_size); 
             number_of_bins << max_box(0) - min_box(0) + 1, max_box(1) - min_box(1) + 1, max_box(2) - min_box(2) + 1;
 
+            grid_size_ = leaf_size;
+            source_ = min_point;
+
+            compute_grid(number_of_bins);
+        }
+
+        // voxelize the world-space box [roi_min, roi_max] only, the points outside still contribute to the values
+        void init(const Eigen::Vector3d & roi_min, const Eigen::Vector3d & roi_max, double leaf_size) {
+            Eigen::Vector3i number_of_bins;
+            for (int i=0; i<3; i++)
+                number_of_bins(i) = std::max(1, int(floor((roi_max(i) - roi_min(i)) / leaf_size)) + 1);
+
+            rotation_ = Eigen::Matrix3d::Identity();
+            grid_size_ = leaf_size;
+            source_ = roi_min;
+            grid_resolution_ = number_of_bins.maxCoeff();
+            bounding_box_scale_ = 1;
+
+            compute_grid(number_of_bins);
+        }
+
+        // fill the grid from grid_size_, source_ and rotation_
+        void compute_grid(const Eigen::Vector3i & number_of_bins) {
             SDF_.resize(number_of_bins(0), number_of_bins(1), number_of_bins(2));
+            if (store_closest_points_)
+                closest_points_.resize(number_of_bins(0), number_of_bins(1), number_of_bins(2));
 
-            nanoflann_wrapper tree(vertices_);
+            tree_ = std::make_shared<nanoflann_wrapper>(vertices_);
             for (int x = 0; x < number_of_bins(0); ++x)
                 for (int y = 0; y < number_of_bins(1); ++y)
                 {
                     #pragma omp parallel for
                     for (int z = 0; z < number_of_bins(2); ++z)
+                        compute_voxel(x, y, z);
+                }
+        }
+
+        // value of one voxel from its closest point
+        inline void compute_voxel(int x, int y, int z) {
+            std::vector< int > closest_point;
+            Eigen::Vector3d point;
+            point << x, y, z;
+            point *= grid_size_;
+            point += source_;
+            point = rotation_ * point;
+            closest_point = tree_->return_k_closest_points(point, 1);
+            double sign = ( vertices_.col(closest_point[0]) - point ).dot( normals_.col(closest_point[0]) );
+            sign /= abs(sign);
+
+            SDF_(x, y, z) = ( vertices_.col(closest_point[0]) - point ).norm() * sign;
+            if (store_closest_points_)
+                closest_points_(x, y, z) = closest_point[0];
+        }
+
+        // Update the grid after an edit of the input points: the points whose
+        // index is in removed are dropped and the added ones are appended. A
+        // voxel can only change if a removed point was its closest one, or if an
+        // added point is closer than its current closest one; both imply that
+        // the changed point lies within d(c) + 2h of the center c of the brick
+        // holding the voxel, where d is the distance to the closest point (which
+        // is 1-Lipschitz) and h the brick half diagonal. Only those bricks are
+        // recomputed, the extent of the grid is kept. Returns the number of
+        // recomputed bricks, or -1 without changing anything if the SDF was
+        // not built from points or the edit is invalid.
+        int update(const std::vector<int> & removed, const Eigen::MatrixXd & added_vertices, const Eigen::MatrixXd & added_normals) {
+            if (!tree_) {
+                std::cout << "Error: the SDF was not built from points, it cannot be updated\n";
+                return -1;
+            }
+            if (added_normals.cols() != added_vertices.cols() || (added_vertices.cols() > 0 && (added_vertices.rows() != 3 || added_normals.rows() != 3))) {
+                std::cout << "Error: the added points need a 3D position and a normal each\n";
+                return -1;
+            }
+            std::vector<bool> is_removed(vertices_.cols(), false);
+            for (int i=0; i<removed.size(); i++) {
+                if (removed[i] < 0 || removed[i] >= vertices_.cols() || is_removed[removed[i]]) {
+                    std::cout << "Error: the removed point " << removed[i] << " is out of range or repeated\n";
+                    return -1;
+                }
+                is_removed[removed[i]] = true;
+            }
+
+            const int brick_size = 8;
+            Eigen::Vector3i number_of_bins(SDF_.dimension(0), SDF_.dimension(1), SDF_.dimension(2));
+            Eigen::Vector3i number_of_bricks = (number_of_bins.array() + brick_size - 1) / brick_size;
+
+            Eigen::MatrixXd changed(3, removed.size() + added_vertices.cols());
+            for (int i=0; i<removed.size(); i++)
+                changed.col(i) = vertices_.col(removed[i]);
+            changed.rightCols(added_vertices.cols()) = added_vertices;
+
+            // bricks which can be affected, found with the old points
+            std::vector< Eigen::Vector3i > dirty_bricks;
+            #pragma omp parallel for collapse(3) schedule(dynamic)
+            for (int bx = 0; bx < number_of_bricks(0); ++bx)
+                for (int by = 0; by < number_of_bricks(1); ++by)
+                    for (int bz = 0; bz < number_of_bricks(2); ++bz)
                     {
-                        std::vector< int > closest_point;
-                        Eigen::Vector3d point;
-                        point << x, y, z;
-                        point *= leaf_size;
-                        point += min_point;
-                        closest_point = tree.return_k_closest_points(point, 1);
-                        double sign = ( vertices_.col(closest_point[0]) - point ).dot( normals_.col(closest_point[0]) );
-                        sign /= abs(sign);
-
-                        SDF_(x, y, z) = ( vertices_.col(closest_point[0]) - point ).norm() * sign;
+                        Eigen::Vector3i first(bx, by, bz), last;
+                        first *= brick_size;
+                        last = (first.array() + brick_size).min(number_of_bins.array()) - 1;
+
+                        Eigen::Vector3d center = rotation_ * ((first + last).cast<double>() * 0.5 * grid_size_ + source_);
+                        double half_diagonal = 0.5 * grid_size_ * (last - first).cast<double>().norm();
+
+                        std::vector<int> closest_point;
+                        std::vector<double> squared_distance;
+                        tree_->return_k_closest_points(center, 1, closest_point, squared_distance);
+                        double radius = sqrt(squared_distance[0]) + 2 * half_diagonal;
+
+                        bool dirty = false;
+                        for (int i=0; i<changed.cols() && !dirty; i++)
+                            dirty = (changed.col(i) - center).squaredNorm() <= radius * radius;
+
+                        if (dirty) {
+                            #pragma omp critical
+                            dirty_bricks.push_back(first);
+                        }
                     }
+
+            // new set of points
+            Eigen::MatrixXd vertices(3, vertices_.cols() - removed.size() + added_vertices.cols());
+            Eigen::MatrixXd normals(3, vertices.cols());
+            std::vector<int> new_index(vertices_.cols(), -1);
+            int kept = 0;
+            for (int i=0; i<vertices_.cols(); i++)
+                if (!is_removed[i]) {
+                    vertices.col(kept) = vertices_.col(i);
+                    normals.col(kept) = normals_.col(i);
+                    new_index[i] = kept;
+                    kept++;
                 }
-            
-            grid_size_ = leaf_size;
-            source_ = min_point;
+            vertices.rightCols(added_vertices.cols()) = added_vertices;
+            normals.rightCols(added_normals.cols()) = added_normals;
+            vertices_.swap(vertices);
+            normals_.swap(normals);
+            tree_ = std::make_shared<nanoflann_wrapper>(vertices_);
+
+            // the kept points are renumbered, the removed ones are only closest in the dirty bricks
+            if (store_closest_points_) {
+                int * closest_points = closest_points_.data();
+                #pragma omp parallel for
+                for (long int i = 0; i < long(closest_points_.size()); ++i)
+                    closest_points[i] = new_index[closest_points[i]];
+            }
+
+            #pragma omp parallel for schedule(dynamic)
+            for (int b = 0; b < dirty_bricks.size(); ++b) {
+                Eigen::Vector3i first = dirty_bricks[b];
+                Eigen::Vector3i last = (first.array() + brick_size).min(number_of_bins.array());
+                for (int x = first(0); x < last(0); ++x)
+                    for (int y = first(1); y < last(1); ++y)
+                        for (int z = first(2); z < last(2); ++z)
+                            compute_voxel(x, y, z);
+            }
+
+            // the gradients read one voxel around each brick
+            if (gradients_.cols() == SDF_.size())
+                for (int b = 0; b < dirty_bricks.size(); ++b) {
+                    Eigen::Vector3i first = (dirty_bricks[b].array() - 1).max(0);
+                    Eigen::Vector3i last = (dirty_bricks[b].array() + brick_size + 1).min(number_of_bins.array());
+                    compute_gradients(first, last);
+                }
+
+            return dirty_bricks.size();
+        }
+
+        // Integrate a depth map (in meters, row v and column u, 0 where there
+        // is no measure) seen by a pinhole camera with the given intrinsics and
+        // pose (camera frame to world frame), as a truncated signed distance:
+        // each voxel in front of a measure takes the depth difference along the
+        // optical axis, positive behind the surface (inside) and clamped to
+        // [-truncation, truncation], and the voxels further than truncation
+        // behind the surface are left untouched. Values are running averages
+        // weighted by the number of observations, up to max_weight so that the
+        // volume can still follow changes.
+        //
+        // The grid goes by 8^3 bricks in parallel, a brick being skipped when
+        // its corners project outside the image, or when it lies beyond the
+        // deepest measure of the 16x16 pixel tiles it projects on. In a brick,
+        // the camera coordinates are affine along each row of voxels, so a row
+        // is projected in one simd loop before the depth lookups. Returns the
+        // number of bricks touched.
+        int integrate_depth(const Eigen::MatrixXf & depth, const Eigen::Matrix3d & intrinsics, const Eigen::Matrix4d & camera_to_world,
+                            double truncation, float max_weight = 64) {
+            const int brick_size = 8;
+            const int nx = SDF_.dimension(0), ny = SDF_.dimension(1), nz = SDF_.dimension(2);
+            const int width = depth.cols(), height = depth.rows();
+            const long int stride_y = nx, stride_z = long(nx) * ny;
+
+            if (weights_.size() != SDF_.size()) {
+                weights_.resize(nx, ny, nz);
+                weights_.setZero();
+            }
+
+            // voxel indices to camera coordinates: camera = A * index + b
+            const Eigen::Matrix3d world_to_camera = camera_to_world.topLeftCorner<3, 3>().transpose();
+            const Eigen::Matrix3d A = world_to_camera * rotation_ * grid_size_;
+            const Eigen::Vector3d b = world_to_camera * (rotation_ * source_ - camera_to_world.topRightCorner<3, 1>());
+            const double fx = intrinsics(0, 0), fy = intrinsics(1, 1), cx = intrinsics(0, 2), cy = intrinsics(1, 2);
+            const float max_depth = depth.maxCoeff();
+            if (max_depth <= 0)
+                return 0;
+
+            // deepest measure of each 16x16 tile of the image, for the occlusion test of the bricks
+            const int tile_size = 16;
+            const int tiles_u = (width + tile_size - 1) / tile_size, tiles_v = (height + tile_size - 1) / tile_size;
+            Eigen::MatrixXf tile_max_depth = Eigen::MatrixXf::Zero(tiles_v, tiles_u);
+            for (int u = 0; u < width; ++u)
+                for (int v = 0; v < height; ++v)
+                    tile_max_depth(v / tile_size, u / tile_size) = std::max(tile_max_depth(v / tile_size, u / tile_size), depth(v, u));
+
+            // bricks in the frustum and in front of the deepest measure of their footprint (plus truncation)
+            const Eigen::Vector3i number_of_bricks((nx + brick_size - 1) / brick_size, (ny + brick_size - 1) / brick_size, (nz + brick_size - 1) / brick_size);
+            std::vector< Eigen::Vector3i > bricks;
+            for (int bz = 0; bz < number_of_bricks(2); ++bz)
+                for (int by = 0; by < number_of_bricks(1); ++by)
+                    for (int bx = 0; bx < number_of_bricks(0); ++bx) {
+                        const Eigen::Vector3i first(bx * brick_size, by * brick_size, bz * brick_size);
+                        const Eigen::Vector3i last = (first.array() + brick_size).min(Eigen::Array3i(nx, ny, nz)) - 1;
+                        double min_z = std::numeric_limits<double>::max();
+                        double min_u = min_z, min_v = min_z, max_u = -min_z, max_v = -min_z;
+                        int behind = 0;
+                        for (int c = 0; c < 8; ++c) {
+                            const Eigen::Vector3d corner(c & 1 ? last(0) : first(0), c & 2 ? last(1) : first(1), c & 4 ? last(2) : first(2));
+                            const Eigen::Vector3d camera = A * corner + b;
+                            min_z = std::min(min_z, camera(2));
+                            if (camera(2) <= 0) {
+                                behind++;
+                                continue;
+                            }
+                            const double u = fx * camera(0) / camera(2) + cx, v = fy * camera(1) / camera(2) + cy;
+                            min_u = std::min(min_u, u); max_u = std::max(max_u, u);
+                            min_v = std::min(min_v, v); max_v = std::max(max_v, v);
+                        }
+                        if (behind == 8 || min_z > max_depth + truncation)
+                            continue;
+
+                        // a brick crossing the camera plane has an unbounded footprint and is kept
+                        if (!behind) {
+                            if (max_u < -0.5 || max_v < -0.5 || min_u > width - 0.5 || min_v > height - 0.5)
+                                continue;
+                            const int first_u = std::max(0, int(min_u + 0.5)) / tile_size, last_u = std::min(width - 1, int(max_u + 0.5)) / tile_size;
+                            const int first_v = std::max(0, int(min_v + 0.5)) / tile_size, last_v = std::min(height - 1, int(max_v + 0.5)) / tile_size;
+                            if (min_z > tile_max_depth.block(first_v, first_u, last_v - first_v + 1, last_u - first_u + 1).maxCoeff() + truncation)
+                                continue;
+                        }
+                        bricks.push_back(first);
+                    }
+
+            double * values = SDF_.data();
+            float * weights = weights_.data();
+
+            #pragma omp parallel for schedule(dynamic)
+            for (int i = 0; i < bricks.size(); ++i) {
+                const Eigen::Vector3i first = bricks[i];
+                const Eigen::Vector3i last = (first.array() + brick_size).min(Eigen::Array3i(nx, ny, nz));
+                const int count = last(0) - first(0);
+                float camera_z[brick_size], u[brick_size], v[brick_size];
+
+                for (int z = first(2); z < last(2); ++z)
+                    for (int y = first(1); y < last(1); ++y) {
+                        const Eigen::Vector3d start = A * Eigen::Vector3d(first(0), y, z) + b;
+                        const Eigen::Vector3d step = A.col(0);
+
+                        // projection of the row
+                        #pragma omp simd
+                        for (int l = 0; l < brick_size; ++l) {
+                            const float X = start(0) + l * step(0), Y = start(1) + l * step(1), Z = start(2) + l * step(2);
+                            const float inv_z = 1.0f / Z;
+                            camera_z[l] = Z;
+                            u[l] = fx * X * inv_z + cx + 0.5f;
+                            v[l] = fy * Y * inv_z + cy + 0.5f;
+                        }
+
+                        // depth lookups and running averages
+                        const long int row = first(0) + y * stride_y + z * stride_z;
+                        for (int l = 0; l < count; ++l) {
+                            if (camera_z[l] <= 0 || u[l] < 0 || v[l] < 0 || u[l] >= width || v[l] >= height)
+                                continue;
+                            const float measure = depth(int(v[l]), int(u[l]));
+                            if (measure <= 0)
+                                continue;
+                            const double distance = camera_z[l] - measure;
+                            if (distance > truncation)
+                                continue;
+                            const double value = std::max(distance, -truncation);
+                            const float weight = weights[row + l];
+                            values[row + l] = (values[row + l] * weight + value) / (weight + 1);
+                            weights[row + l] = std::min(weight + 1, max_weight);
+                        }
+                    }
+            }
+
+            // the precomputed gradients around the touched bricks are refreshed
+            if (gradients_.size() > 0)
+                for (int i = 0; i < bricks.size(); ++i) {
+                    const Eigen::Vector3i first = (bricks[i].array() - 1).max(0);
+                    const Eigen::Vector3i last = (bricks[i].array() + brick_size + 1).min(Eigen::Array3i(nx, ny, nz));
+                    compute_gradients(first, last);
+                }
+
+            return bricks.size();
+        }
+
+        // Combine this SDF (a) with another one (b): union max(a, b),
+        // intersection min(a, b), difference min(a, -b), or a smooth union
+        // blending over a band of width smoothness. When both grids share the
+        // same layout the values are combined voxel by voxel, otherwise the
+        // result is an axis-aligned grid with the finer leaf size over the
+        // box of the union (the box of a for the other operations) and both
+        // inputs are resampled trilinearly, outside their box a value is
+        // lowered by the distance to the box. The result is written in a
+        // single pass over 8^3 bricks in parallel, each row of 8 voxels
+        // going through one sample_block per input.
+        SDF combine(SDF & other, CSGOperation operation, double smoothness = 0) {
+            const bool same_layout = SDF_.dimension(0) == other.SDF_.dimension(0) && SDF_.dimension(1) == other.SDF_.dimension(1) &&
+                                     SDF_.dimension(2) == other.SDF_.dimension(2) && grid_size_ == other.grid_size_ &&
+                                     source_ == other.source_ && rotation_ == other.rotation_;
+
+            SDF result(Eigen::Tensor<double, 3>(), grid_size_, source_, rotation_);
+            Eigen::Vector3i number_of_bins(SDF_.dimension(0), SDF_.dimension(1), SDF_.dimension(2));
+
+            if (!same_layout) {
+                // world boxes of the inputs
+                Eigen::Vector3d min_point = Eigen::Vector3d::Constant(std::numeric_limits<double>::max());
+                Eigen::Vector3d max_point = -min_point;
+                SDF * inputs[2] = {this, &other};
+                for (int i = 0; i < (operation == CSG_UNION || operation == CSG_SMOOTH_UNION ? 2 : 1); ++i) {
+                    Eigen::Vector3d box_min, box_max;
+                    inputs[i]->get_world_box(box_min, box_max);
+                    min_point = min_point.cwiseMin(box_min);
+                    max_point = max_point.cwiseMax(box_max);
+                }
+
+                result.grid_size_ = std::min(grid_size_, other.grid_size_);
+                result.source_ = min_point;
+                result.rotation_ = Eigen::Matrix3d::Identity();
+                for (int i = 0; i < 3; ++i)
+                    number_of_bins(i) = int(std::floor((max_point(i) - min_point(i)) / result.grid_size_)) + 1;
+                result.grid_resolution_ = number_of_bins.maxCoeff();
+            }
+            result.SDF_.resize(number_of_bins(0), number_of_bins(1), number_of_bins(2));
+
+            const int brick_size = 8;
+            Eigen::Vector3i number_of_bricks = (number_of_bins.array() + brick_size - 1) / brick_size;
+            const long int stride_y = number_of_bins(0), stride_z = long(number_of_bins(0)) * number_of_bins(1);
+            double * output = result.SDF_.data();
+
+            #pragma omp parallel for collapse(3) schedule(dynamic)
+            for (int bz = 0; bz < number_of_bricks(2); ++bz)
+                for (int by = 0; by < number_of_bricks(1); ++by)
+                    for (int bx = 0; bx < number_of_bricks(0); ++bx)
+                    {
+                        double points[24], a[8], b[8];
+                        for (int z = bz * brick_size; z < std::min((bz + 1) * brick_size, number_of_bins(2)); ++z)
+                            for (int y = by * brick_size; y < std::min((by + 1) * brick_size, number_of_bins(1)); ++y)
+                            {
+                                const int first = bx * brick_size;
+                                const int count = std::min(brick_size, number_of_bins(0) - first);
+                                const long int offset = first + y * stride_y + z * stride_z;
+
+                                if (same_layout) {
+                                    for (int l = 0; l < count; ++l) {
+                                        a[l] = SDF_.data()[offset + l];
+                                        b[l] = other.SDF_.data()[offset + l];
+                                    }
+                                } else {
+                                    for (int l = 0; l < count; ++l)
+                                        Eigen::Map<Eigen::Vector3d>(points + 3*l) = result.rotation_ * (Eigen::Vector3d(first + l, y, z) * result.grid_size_ + result.source_);
+                                    sample_block_outside(points, count, a);
+                                    other.sample_block_outside(points, count, b);
+                                }
+
+                                for (int l = 0; l < count; ++l) {
+                                    double value;
+                                    switch (operation) {
+                                        case CSG_UNION:        value = std::max(a[l], b[l]); break;
+                                        case CSG_INTERSECTION: value = std::min(a[l], b[l]); break;
+                                        case CSG_DIFFERENCE:   value = std::min(a[l], -b[l]); break;
+                                        case CSG_SMOOTH_UNION: {
+                                            // polynomial smooth maximum
+                                            double h = smoothness > 0 ? std::min(std::max(0.5 + 0.5 * (a[l] - b[l]) / smoothness, 0.0), 1.0) : (a[l] > b[l] ? 1.0 : 0.0);
+                                            value = b[l] + h * (a[l] - b[l]) + smoothness * h * (1 - h);
+                                            break;
+                                        }
+                                    }
+                                    output[offset + l] = value;
+                                }
+                            }
+                    }
+
+            return result;
+        }
+
+        // corners of the grid box, as an axis-aligned world box
+        inline void get_world_box(Eigen::Vector3d & box_min, Eigen::Vector3d & box_max) {
+            box_min = Eigen::Vector3d::Constant(std::numeric_limits<double>::max());
+            box_max = -box_min;
+            for (int corner = 0; corner < 8; ++corner) {
+                Eigen::Vector3d point((corner & 1) * (SDF_.dimension(0) - 1), ((corner >> 1) & 1) * (SDF_.dimension(1) - 1), ((corner >> 2) & 1) * (SDF_.dimension(2) - 1));
+                point = rotation_ * (point * grid_size_ + source_);
+                box_min = box_min.cwiseMin(point);
+                box_max = box_max.cwiseMax(point);
+            }
+        }
+
+        // sample_block, lowered by the distance to the grid box for the points
+        // outside (the gradients, if any, are the ones of the clamped lookup)
+        inline void sample_block_outside(const double * points, int count, double * distances, double * gradients = NULL) {
+            sample_block(points, count, distances, gradients);
+            const Eigen::Vector3d box_max = source_ + grid_size_ * Eigen::Vector3d(SDF_.dimension(0) - 1, SDF_.dimension(1) - 1, SDF_.dimension(2) - 1);
+            for (int l = 0; l < count; ++l) {
+                Eigen::Vector3d local = rotation_.transpose() * Eigen::Map<const Eigen::Vector3d>(points + 3*l);
+                Eigen::Vector3d outside = (source_ - local).cwiseMax(local - box_max).cwiseMax(0);
+                distances[l] -= outside.norm();
+            }
+        }
+
+        // Map the closest points back to the mesh when the SDF is built from
+        // sample_surface(V, F, ...): each voxel gets its closest face and the
+        // barycentric coordinates of its projection on that face (one column
+        // per voxel, in the tensor order). Only the closest sample recorded
+        // for each voxel while the grid was computed is read, there is no
+        // second round of tree queries. Its face is not always the closest
+        // face, so the candidates are that face and the faces sharing a vertex
+        // with it, and the nearest projection is kept. The result is exact
+        // unless the closest face is not next to the face of the closest
+        // sample (e.g. a sliver much thinner than the sample spacing). The
+        // closest points must have been stored at construction.
+        inline bool get_closest_faces(const Eigen::MatrixXd & V, const Eigen::MatrixXi & F, const Eigen::VectorXi & samples_faces,
+                                      Eigen::Tensor<int, 3> & faces, Eigen::Matrix<float, 3, Eigen::Dynamic> & barycentric) {
+            if (closest_points_.size() != SDF_.size()) {
+                std::cout << "Error: the closest points were not stored\n";
+                return false;
+            }
+
+            faces.resize(SDF_.dimension(0), SDF_.dimension(1), SDF_.dimension(2));
+            barycentric.resize(3, SDF_.size());
+            const long int stride_y = SDF_.dimension(0), stride_z = long(SDF_.dimension(0)) * SDF_.dimension(1);
+
+            // faces around each vertex
+            std::vector< std::vector<int> > vertex_faces(V.cols());
+            for (int f = 0; f < F.cols(); ++f)
+                for (int j = 0; j < 3; ++j)
+                    vertex_faces[F(j, f)].push_back(f);
+
+            #pragma omp parallel for
+            for (int z = 0; z < SDF_.dimension(2); ++z)
+            {
+                std::vector<int> candidates;
+                for (int y = 0; y < SDF_.dimension(1); ++y)
+                    for (int x = 0; x < SDF_.dimension(0); ++x)
+                    {
+                        const Eigen::Vector3d point = rotation_ * (Eigen::Vector3d(x, y, z) * grid_size_ + source_);
+                        const int closest_face = samples_faces(closest_points_(x, y, z));
+                        candidates.clear();
+                        for (int j = 0; j < 3; ++j)
+                            candidates.insert(candidates.end(), vertex_faces[F(j, closest_face)].begin(), vertex_faces[F(j, closest_face)].end());
+
+                        double best = std::numeric_limits<double>::max();
+                        for (int c = 0; c < candidates.size(); ++c) {
+                            const int face = candidates[c];
+                            const Eigen::Vector3d weights = closest_point_on_triangle(point, V.col(F(0, face)), V.col(F(1, face)), V.col(F(2, face)));
+                            const double distance = (weights(0) * V.col(F(0, face)) + weights(1) * V.col(F(1, face)) + weights(2) * V.col(F(2, face)) - point).squaredNorm();
+                            if (distance < best) {
+                                best = distance;
+                                faces(x, y, z) = face;
+                                barycentric.col(x + y * stride_y + z * stride_z) = weights.cast<float>();
+                            }
+                        }
+                    }
+            }
+
+            return true;
+        }
+
+        // Precompute the gradient of every voxel with central differences
+        // (one-sided on the border), rotated to the world frame and packed as
+        // float3 so that a lookup is a single 12 bytes fetch. The pass runs
+        // over 16x16 tiles of (y, z), x innermost, so the four neighbouring
+        // rows of a tile stay in cache; tiles are spread over the threads.
+        void compute_gradient_field() {
+            gradients_.resize(3, SDF_.size());
+            compute_gradients(Eigen::Vector3i::Zero(), Eigen::Vector3i(SDF_.dimension(0), SDF_.dimension(1), SDF_.dimension(2)));
+        }
+
+        // gradients of the voxels in [first, last)
+        void compute_gradients(const Eigen::Vector3i & first, const Eigen::Vector3i & last) {
+            const int tile_size = 16;
+            const int nx = SDF_.dimension(0), ny = SDF_.dimension(1), nz = SDF_.dimension(2);
+            const long int stride_y = nx, stride_z = long(nx) * ny;
+            const double * grid = SDF_.data();
+            const Eigen::Matrix3f to_world = rotation_.cast<float>();
+
+            const int tiles_y = (last(1) - first(1) + tile_size - 1) / tile_size;
+            const int tiles_z = (last(2) - first(2) + tile_size - 1) / tile_size;
+
+            #pragma omp parallel for collapse(2) schedule(static)
+            for (int tz = 0; tz < tiles_z; ++tz)
+                for (int ty = 0; ty < tiles_y; ++ty)
+                    for (int z = first(2) + tz*tile_size; z < std::min(first(2) + (tz+1)*tile_size, last(2)); ++z)
+                        for (int y = first(1) + ty*tile_size; y < std::min(first(1) + (ty+1)*tile_size, last(1)); ++y)
+                        {
+                            // neighbouring rows and the spacing of the differences on the borders
+                            const int y0 = std::max(y - 1, 0), y1 = std::min(y + 1, ny - 1);
+                            const int z0 = std::max(z - 1, 0), z1 = std::min(z + 1, nz - 1);
+                            const double * row_y0 = grid + y0 * stride_y + z * stride_z;
+                            const double * row_y1 = grid + y1 * stride_y + z * stride_z;
+                            const double * row_z0 = grid + y * stride_y + z0 * stride_z;
+                            const double * row_z1 = grid + y * stride_y + z1 * stride_z;
+                            const double * row = grid + y * stride_y + z * stride_z;
+                            const double inv_dy = y1 > y0 ? 1.0 / ((y1 - y0) * grid_size_) : 0.0;
+                            const double inv_dz = z1 > z0 ? 1.0 / ((z1 - z0) * grid_size_) : 0.0;
+
+                            for (int x = first(0); x < last(0); ++x) {
+                                const int x0 = std::max(x - 1, 0), x1 = std::min(x + 1, nx - 1);
+                                const double inv_dx = x1 > x0 ? 1.0 / ((x1 - x0) * grid_size_) : 0.0;
+                                Eigen::Vector3f gradient((row[x1] - row[x0]) * inv_dx,
+                                                         (row_y1[x] - row_y0[x]) * inv_dy,
+                                                         (row_z1[x] - row_z0[x]) * inv_dz);
+                                gradients_.col(x + y * stride_y + z * stride_z) = to_world * gradient;
+                            }
+                        }
+        }
+
+        // precomputed gradient of the voxel closest to a world-space point (clamped to the grid),
+        // zero if compute_gradient_field has not been called on the current grid
+        inline Eigen::Vector3f get_gradient(const Eigen::Vector3d & point) {
+            if (gradients_.cols() != SDF_.size()) {
+                std::cout << "Error: the gradient field is not computed, call compute_gradient_field first\n";
+                return Eigen::Vector3f::Zero();
+            }
+
+            Eigen::Vector3d q = (rotation_.transpose() * point - source_) / grid_size_;
+            long int index = 0, stride = 1;
+            for (int i = 0; i < 3; ++i) {
+                int coordinate = std::min(std::max(int(std::floor(q(i) + 0.5)), 0), int(SDF_.dimension(i)) - 1);
+                index += coordinate * stride;
+                stride *= SDF_.dimension(i);
+            }
+            return gradients_.col(index);
+        }
+
+        // Trilinear interpolation of the grid (and its gradient) at world-space
+        // points, clamped to the grid extent (outside the grid the gradient of the
+        // closest boundary cell is kept). Points go by blocks of 8: the cell
+        // offsets and weights of a block are computed in simd lanes, then the
+        // corners are fetched from the ColMajor tensor data (x fastest) and
+        // blended in a second simd loop. Blocks are spread over the threads.
+        inline void sample(const Eigen::MatrixXd & points, Eigen::VectorXd & distances, Eigen::MatrixXd & gradients) {
+            sample(points, distances, &gradients);
+        }
+
+        inline void sample(const Eigen::MatrixXd & points, Eigen::VectorXd & distances) {
+            sample(points, distances, NULL);
+        }
+
+        inline double sample(const Eigen::Vector3d & point) {
+            Eigen::VectorXd distance;
+            sample(Eigen::MatrixXd(point), distance, NULL);
+            return distance(0);
+        }
+
+        void sample(const Eigen::MatrixXd & points, Eigen::VectorXd & distances, Eigen::MatrixXd * gradients) {
+            const long int number_of_points = points.cols();
+            const long int number_of_blocks = (number_of_points + 7) / 8;
+            distances.resize(number_of_points);
+            if (gradients)
+                gradients->resize(3, number_of_points);
+
+            #pragma omp parallel for schedule(static)
+            for (long int b = 0; b < number_of_blocks; ++b)
+                sample_block(points.data() + 24*b, std::min(8L, number_of_points - 8*b),
+                             distances.data() + 8*b, gradients ? gradients->data() + 24*b : NULL);
+        }
+
+        // up to 8 packed xyz points, gradients (packed xyz too) can be NULL
+        inline void sample_block(const double * points, int count, double * distances, double * gradients) {
+            const int nx = SDF_.dimension(0), ny = SDF_.dimension(1), nz = SDF_.dimension(2);
+            const long int stride_y = nx, stride_z = long(nx) * ny;
+            const double * grid = SDF_.data();
+
+            // point to continuous grid coordinates: (R^T p - source) / grid_size
+            const Eigen::Matrix3d to_grid = rotation_.transpose() / grid_size_;
+            const Eigen::Vector3d offset = source_ / grid_size_;
+
+            double fx[8], fy[8], fz[8];
+            long int base[8];
+            int step_x[8], step_y[8], step_z[8];
+
+            // the missing lanes repeat the last point
+            #pragma omp simd
+            for (int l = 0; l < 8; ++l) {
+                const double * p = points + 3*std::min(l, count - 1);
+                double q[3];
+                for (int r = 0; r < 3; ++r)
+                    q[r] = to_grid(r, 0) * p[0] + to_grid(r, 1) * p[1] + to_grid(r, 2) * p[2] - offset(r);
+
+                double qx = std::min(std::max(q[0], 0.0), double(nx - 1));
+                double qy = std::min(std::max(q[1], 0.0), double(ny - 1));
+                double qz = std::min(std::max(q[2], 0.0), double(nz - 1));
+                int x = std::min(int(qx), std::max(nx - 2, 0));
+                int y = std::min(int(qy), std::max(ny - 2, 0));
+                int z = std::min(int(qz), std::max(nz - 2, 0));
+
+                fx[l] = qx - x; fy[l] = qy - y; fz[l] = qz - z;
+                step_x[l] = nx > 1; step_y[l] = ny > 1; step_z[l] = nz > 1;
+                base[l] = x + y * stride_y + z * stride_z;
+            }
+
+            double corners[8][8];
+            for (int l = 0; l < 8; ++l) {
+                const double * c = grid + base[l];
+                const long int dx = step_x[l], dy = step_y[l] * stride_y, dz = step_z[l] * stride_z;
+                corners[0][l] = c[0];       corners[1][l] = c[dx];
+                corners[2][l] = c[dy];      corners[3][l] = c[dx + dy];
+                corners[4][l] = c[dz];      corners[5][l] = c[dx + dz];
+                corners[6][l] = c[dy + dz]; corners[7][l] = c[dx + dy + dz];
+            }
+
+            double value[8], gx[8], gy[8], gz[8];
+            #pragma omp simd
+            for (int l = 0; l < 8; ++l) {
+                double c00 = corners[0][l] + fx[l] * (corners[1][l] - corners[0][l]);
+                double c10 = corners[2][l] + fx[l] * (corners[3][l] - corners[2][l]);
+                double c01 = corners[4][l] + fx[l] * (corners[5][l] - corners[4][l]);
+                double c11 = corners[6][l] + fx[l] * (corners[7][l] - corners[6][l]);
+                double c0 = c00 + fy[l] * (c10 - c00);
+                double c1 = c01 + fy[l] * (c11 - c01);
+                value[l] = c0 + fz[l] * (c1 - c0);
+
+                double dx00 = corners[1][l] - corners[0][l], dx10 = corners[3][l] - corners[2][l];
+                double dx01 = corners[5][l] - corners[4][l], dx11 = corners[7][l] - corners[6][l];
+                double dx0 = dx00 + fy[l] * (dx10 - dx00);
+                double dx1 = dx01 + fy[l] * (dx11 - dx01);
+                gx[l] = dx0 + fz[l] * (dx1 - dx0);
+                gy[l] = (c10 - c00) + fz[l] * ((c11 - c01) - (c10 - c00));
+                gz[l] = c1 - c0;
+            }
+
+            for (int l = 0; l < count; ++l)
+                distances[l] = value[l];
+
+            if (gradients) {
+                const Eigen::Matrix3d to_world = rotation_ / grid_size_;
+                for (int l = 0; l < count; ++l)
+                    Eigen::Map<Eigen::Vector3d>(gradients + 3*l) = to_world * Eigen::Vector3d(gx[l], gy[l], gz[l]);
+            }
         }
 
         inline bool generate_graph(Eigen::MatrixXd & vertices, Eigen::MatrixXi & edges)
@@ -159,7 +872,7 @@ class SDF
             
             vertices.resize(3, vertices_vector.size());
             for (int i=0; i< vertices_vector.size(); i++)
-                vertices.col(i) = vertices_vector[i];
+                vertices.col(i) = rotation_ * vertices_vector[i];
 
             edges.resize(2, edges_vector.size());
             for (int i=0; i< edges_vector.size(); i++)
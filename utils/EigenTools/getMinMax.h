@@ -3,12 +3,27 @@
 
 #include <Eigen/Core>
 
-static inline void getMinMax(Eigen::MatrixXd & in_cloud, Eigen::Vector3d & min_point, Eigen::Vector3d & max_point){
+static inline void getMinMax(const Eigen::MatrixXd & in_cloud, Eigen::Vector3d & min_point, Eigen::Vector3d & max_point){
     max_point = in_cloud.rowwise().maxCoeff();
     min_point = in_cloud.rowwise().minCoeff();
 };
 
-inline void getScale(Eigen::MatrixXd in_cloud, double & scale){
+// voxel size used by the voxelizers: the grid_resolution bins span the largest side of the bounding box
+inline double getLeafSize(const Eigen::Vector3d & min_point, const Eigen::Vector3d & max_point, int grid_resolution, double bounding_box_scale){
+    double bounding_box_size = (max_point - min_point).maxCoeff() * bounding_box_scale; // diagonal versus max direction
+    return bounding_box_size/(grid_resolution-1);
+};
+
+inline double getLeafSize(const Eigen::MatrixXd & in_cloud, int grid_resolution, double bounding_box_scale){
+    Eigen::Vector3d min_point;
+    Eigen::Vector3d max_point;
+
+    getMinMax(in_cloud, min_point, max_point);
+
+    return getLeafSize(min_point, max_point, grid_resolution, bounding_box_scale);
+};
+
+inline void getScale(const Eigen::MatrixXd & in_cloud, double & scale){
     Eigen::Vector3d min_point;
     Eigen::Vector3d max_point;
 
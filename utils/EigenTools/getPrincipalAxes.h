@@ -0,0 +1,32 @@
+#ifndef GETPRINCIPALAXES_HPP
+#define GETPRINCIPALAXES_HPP
+
+#include <Eigen/Dense>
+
+// rotation whose columns are the principal axes of the cloud (largest variance first), with det = +1
+inline void getPrincipalAxes(const Eigen::MatrixXd & in_cloud, Eigen::Matrix3d & rotation){
+    Eigen::Vector3d mean = in_cloud.rowwise().mean();
+    Eigen::Matrix3d covariance = Eigen::Matrix3d::Zero();
+
+    #pragma omp parallel
+    {
+        Eigen::Matrix3d local_covariance = Eigen::Matrix3d::Zero();
+
+        #pragma omp for nowait
+        for (long int i=0; i<in_cloud.cols(); i++) {
+            Eigen::Vector3d centered = in_cloud.col(i) - mean;
+            local_covariance += centered * centered.transpose();
+        }
+
+        #pragma omp critical
+        covariance += local_covariance;
+    }
+
+    // eigenvalues are sorted in increasing order
+    Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver(covariance);
+    rotation.col(0) = solver.eigenvectors().col(2);
+    rotation.col(1) = solver.eigenvectors().col(1);
+    rotation.col(2) = rotation.col(0).cross(rotation.col(1));
+};
+
+#endif
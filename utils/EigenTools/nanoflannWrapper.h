@@ -11,6 +11,8 @@
 #define NANOFLANN_WRAPPER
 
 #include <iostream>
+#include <vector>
+#include <memory>
 #include <Eigen/Dense>
 
 #include "nanoflann.hpp"
@@ -101,6 +103,37 @@ public:
 
 
 
+	// k closest points of each column of query_points (one column of indexes
+	// per query), the queries are spread over the threads and each thread
+	// reuses its result buffers
+	bool return_k_closest_points(const Eigen::MatrixXd & query_points, int k, Eigen::MatrixXi & indexes)
+	{
+		indexes.resize(k, query_points.cols());
+
+		#pragma omp parallel
+		{
+			std::vector<size_t> ret_indexes(k);
+			std::vector<double> out_dists_sqr(k);
+			double query_pt[3];
+
+			#pragma omp for schedule(dynamic, 256)
+			for (long int i = 0; i < query_points.cols(); i++)
+			{
+				for (int d=0; d<3; d++)
+					query_pt[d] = query_points(d, i);
+
+				nanoflann::KNNResultSet<double> resultSet(k);
+				resultSet.init( &ret_indexes.at(0), &out_dists_sqr.at(0) );
+				this->kd_tree_index->index->findNeighbors(resultSet, query_pt, nanoflann::SearchParams(k));
+
+				for (int j = 0; j < k; j++)
+					indexes(j, i) = j < resultSet.size() ? int(ret_indexes.at(j)) : int(ret_indexes.at(0));
+			}
+		}
+
+		return true;
+	}
+
 	std::vector< int > radius_search(Eigen::Vector3d query_point, double max_dist)
 	{
 		// Query point:
@@ -0,0 +1,414 @@
+/*
+*   memory-mapped PLY reader (binary little endian, zero-copy vertex views)
+*   by R. Falque
+*   18/10/2026
+*/
+
+#ifndef IO_MAPPEDPLY_H
+#define IO_MAPPEDPLY_H
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cstring>
+#include <stdexcept>
+#include <stdint.h>
+#include <Eigen/Core>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+enum PLYFormat { PLY_ASCII, PLY_BINARY_LITTLE_ENDIAN, PLY_BINARY_BIG_ENDIAN };
+
+enum PLYType { PLY_INVALID, PLY_INT8, PLY_UINT8, PLY_INT16, PLY_UINT16, PLY_INT32, PLY_UINT32, PLY_FLOAT32, PLY_FLOAT64 };
+
+inline int ply_type_size(PLYType type) {
+    switch (type) {
+        case PLY_INT8:    case PLY_UINT8:   return 1;
+        case PLY_INT16:   case PLY_UINT16:  return 2;
+        case PLY_INT32:   case PLY_UINT32:  case PLY_FLOAT32: return 4;
+        case PLY_FLOAT64: return 8;
+        default:          return 0;
+    }
+};
+
+inline PLYType ply_type_from_string(const std::string & name) {
+    if (name == "char"   || name == "int8")    return PLY_INT8;
+    if (name == "uchar"  || name == "uint8")   return PLY_UINT8;
+    if (name == "short"  || name == "int16")   return PLY_INT16;
+    if (name == "ushort" || name == "uint16")  return PLY_UINT16;
+    if (name == "int"    || name == "int32")   return PLY_INT32;
+    if (name == "uint"   || name == "uint32")  return PLY_UINT32;
+    if (name == "float"  || name == "float32") return PLY_FLOAT32;
+    if (name == "double" || name == "float64") return PLY_FLOAT64;
+    return PLY_INVALID;
+};
+
+struct PLYProperty
+{
+    std::string name;
+    PLYType type;
+    bool is_list;
+    PLYType list_count_type;
+};
+
+struct PLYElement
+{
+    std::string name;
+    size_t count;
+    std::vector<PLYProperty> properties;
+
+    // index of the property called name, -1 if absent
+    int find(const std::string & name) const {
+        for (size_t i=0; i<properties.size(); i++)
+            if (properties[i].name == name)
+                return i;
+        return -1;
+    };
+};
+
+struct PLYHeader
+{
+    PLYFormat format;
+    std::vector<PLYElement> elements;
+    std::vector<std::string> comments;
+    size_t body_offset;                 // first byte after "end_header\n"
+
+    const PLYElement * find(const std::string & name) const {
+        for (size_t i=0; i<elements.size(); i++)
+            if (elements[i].name == name)
+                return &elements[i];
+        return NULL;
+    };
+};
+
+// parse the ascii header at the start of a PLY buffer
+inline PLYHeader parse_ply_header(const char * data, size_t size) {
+    PLYHeader header;
+    bool has_format = false;
+    size_t position = 0;
+    std::string line;
+
+    while (true) {
+        size_t line_end = position;
+        while (line_end < size && data[line_end] != '\n')
+            line_end++;
+        if (line_end == size)
+            throw std::runtime_error("PLY header is not terminated by end_header");
+
+        line.assign(data + position, line_end - position);
+        if (!line.empty() && line[line.size()-1] == '\r')
+            line.erase(line.size()-1);
+        position = line_end + 1;
+
+        std::istringstream tokens(line);
+        std::string keyword;
+        tokens >> keyword;
+
+        if (keyword == "ply" && header.elements.empty() && !has_format) {
+            continue;
+        } else if (keyword == "format") {
+            std::string format;
+            tokens >> format;
+            if (format == "ascii")                     header.format = PLY_ASCII;
+            else if (format == "binary_little_endian") header.format = PLY_BINARY_LITTLE_ENDIAN;
+            else if (format == "binary_big_endian")    header.format = PLY_BINARY_BIG_ENDIAN;
+            else throw std::runtime_error("unknown PLY format: " + format);
+            has_format = true;
+        } else if (keyword == "comment" || keyword == "obj_info") {
+            header.comments.push_back(line.size() > keyword.size() ? line.substr(keyword.size()+1) : "");
+        } else if (keyword == "element") {
+            PLYElement element;
+            tokens >> element.name >> element.count;
+            if (tokens.fail()) throw std::runtime_error("malformed PLY element line: " + line);
+            header.elements.push_back(element);
+        } else if (keyword == "property") {
+            if (header.elements.empty()) throw std::runtime_error("PLY property declared before any element");
+            PLYProperty property;
+            std::string type;
+            tokens >> type;
+            if (type == "list") {
+                std::string count_type, item_type;
+                tokens >> count_type >> item_type >> property.name;
+                property.is_list = true;
+                property.list_count_type = ply_type_from_string(count_type);
+                property.type = ply_type_from_string(item_type);
+            } else {
+                tokens >> property.name;
+                property.is_list = false;
+                property.list_count_type = PLY_INVALID;
+                property.type = ply_type_from_string(type);
+            }
+            if (property.type == PLY_INVALID || (property.is_list && property.list_count_type == PLY_INVALID))
+                throw std::runtime_error("unknown PLY property type: " + line);
+            header.elements.back().properties.push_back(property);
+        } else if (keyword == "end_header") {
+            break;
+        } else if (!keyword.empty()) {
+            throw std::runtime_error("unexpected PLY header line: " + line);
+        }
+    }
+
+    if (!has_format)
+        throw std::runtime_error("PLY header has no format line");
+
+    header.body_offset = position;
+    return header;
+};
+
+// read-only mapping of a whole file
+class MappedFile
+{
+    private:
+        const char * data_;
+        size_t size_;
+
+        MappedFile(const MappedFile &);
+        MappedFile & operator=(const MappedFile &);
+
+    public:
+
+        MappedFile(const std::string & filepath)
+        {
+            data_ = NULL;
+            size_ = 0;
+
+            int fd = open(filepath.c_str(), O_RDONLY);
+            if (fd < 0) throw std::runtime_error("failed to open " + filepath);
+
+            struct stat file_stat;
+            if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+                close(fd);
+                throw std::runtime_error("failed to stat " + filepath);
+            }
+            size_ = file_stat.st_size;
+
+            void * address = mmap(NULL, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if (address == MAP_FAILED) throw std::runtime_error("failed to mmap " + filepath);
+
+            data_ = static_cast<const char *>(address);
+        }
+
+        // destructor
+        ~MappedFile()
+        {
+            if (data_ != NULL)
+                munmap(const_cast<char *>(data_), size_);
+        }
+
+        //accessors
+        inline const char * data() const {return data_;};
+        inline size_t size() const {return size_;};
+};
+
+// Binary PLY reader that maps the file instead of streaming it: the header
+// is validated and the faces decoded at construction. When the vertex
+// records are float aligned (their size is a multiple of 4 bytes and the
+// positions or normals start on a 4 bytes boundary of the mapped memory),
+// the positions and normals are exposed as strided views over the mapped
+// bytes, without any copy. Other records (e.g. 27 bytes for float
+// positions and normals with uchar colors) cannot be viewed as floats, the
+// get_* functions then decode them with memcpy.
+class MappedPLY
+{
+    public:
+        typedef Eigen::Map<const Eigen::Matrix<float, 3, Eigen::Dynamic>, Eigen::Unaligned, Eigen::OuterStride<> > ConstMap3Xf;
+
+    private:
+        MappedFile file_;
+        PLYHeader header_;
+        const char * vertex_data_;
+        size_t vertex_stride_;          // bytes per vertex record
+        size_t num_vertices_;
+        int position_offset_;           // byte offset of x inside a vertex record
+        int normal_offset_;             // byte offset of nx, -1 if absent
+        int color_offset_;              // byte offset of red, -1 if absent
+        Eigen::Matrix<int, 3, Eigen::Dynamic> faces_;
+
+        // byte offset of three consecutive properties of a given type starting at first, -1 if not laid out that way
+        int triplet_offset(const PLYElement & vertex, const std::string & first, const std::string & second, const std::string & third, PLYType type) {
+            int id = vertex.find(first);
+            if (id < 0 || size_t(id)+2 >= vertex.properties.size())
+                return -1;
+            if (vertex.properties[id+1].name != second || vertex.properties[id+2].name != third)
+                return -1;
+            for (int i=id; i<id+3; i++)
+                if (vertex.properties[i].type != type)
+                    return -1;
+
+            int offset = 0;
+            for (int i=0; i<id; i++)
+                offset += ply_type_size(vertex.properties[i].type);
+            return offset;
+        };
+
+    public:
+
+        MappedPLY(const std::string & filepath) : file_(filepath)
+        {
+            uint16_t endian_probe = 1;
+            if (*reinterpret_cast<uint8_t *>(&endian_probe) != 1)
+                throw std::runtime_error("MappedPLY only supports little endian hosts");
+
+            header_ = parse_ply_header(file_.data(), file_.size());
+            if (header_.format != PLY_BINARY_LITTLE_ENDIAN)
+                throw std::runtime_error(filepath + " is not a binary little endian PLY file");
+
+            const PLYElement * vertex = header_.find("vertex");
+            if (vertex == NULL)
+                throw std::runtime_error(filepath + " has no vertex element");
+
+            // vertex records are fixed size as long as they hold no list
+            vertex_stride_ = 0;
+            for (size_t i=0; i<vertex->properties.size(); i++) {
+                if (vertex->properties[i].is_list)
+                    throw std::runtime_error("list properties on vertices are not supported");
+                vertex_stride_ += ply_type_size(vertex->properties[i].type);
+            }
+
+            position_offset_ = triplet_offset(*vertex, "x", "y", "z", PLY_FLOAT32);
+            normal_offset_ = triplet_offset(*vertex, "nx", "ny", "nz", PLY_FLOAT32);
+            color_offset_ = triplet_offset(*vertex, "red", "green", "blue", PLY_UINT8);
+            if (position_offset_ < 0)
+                throw std::runtime_error("vertex positions must be consecutive float32 x, y, z properties");
+
+            // elements are stored one after the other, the vertices are not necessarily first
+            size_t offset = header_.body_offset;
+            const PLYElement * face = NULL;
+            size_t face_offset = 0;
+            for (size_t i=0; i<header_.elements.size(); i++) {
+                const PLYElement & element = header_.elements[i];
+                if (&element == vertex) {
+                    vertex_data_ = file_.data() + offset;
+                    num_vertices_ = element.count;
+                    offset += vertex_stride_ * element.count;
+                } else if (element.name == "face") {
+                    face = &element;
+                    face_offset = offset;
+                    offset += (1 + 3*4) * element.count;
+                } else {
+                    for (size_t j=0; j<element.properties.size(); j++)
+                        if (element.properties[j].is_list)
+                            throw std::runtime_error("cannot skip the list element " + element.name);
+                    size_t stride = 0;
+                    for (size_t j=0; j<element.properties.size(); j++)
+                        stride += ply_type_size(element.properties[j].type);
+                    offset += stride * element.count;
+                }
+            }
+
+            if (face != NULL) {
+                if (face->properties.size() != 1 || !face->properties[0].is_list ||
+                    face->properties[0].list_count_type != PLY_UINT8 ||
+                    (face->properties[0].type != PLY_INT32 && face->properties[0].type != PLY_UINT32))
+                    throw std::runtime_error("faces must be a single 'list uchar int' property");
+            }
+
+            if (offset > file_.size())
+                throw std::runtime_error(filepath + " is truncated");
+
+            // face records are 13 bytes (uchar count + 3 int), decoded in parallel
+            if (face != NULL) {
+                const char * face_data = file_.data() + face_offset;
+                long int num_faces = face->count;
+                bool only_triangles = true;
+
+                faces_.resize(3, num_faces);
+                #pragma omp parallel for reduction(&&:only_triangles)
+                for (long int i=0; i<num_faces; i++) {
+                    const char * record = face_data + i*13;
+                    only_triangles = only_triangles && uint8_t(record[0]) == 3;
+                    std::memcpy(faces_.col(i).data(), record + 1, 3*sizeof(int));
+                }
+
+                if (!only_triangles)
+                    throw std::runtime_error(filepath + " contains faces which are not triangles");
+            }
+        }
+
+        // destructor
+        ~MappedPLY()
+        {
+        }
+
+        //accessors
+        inline const PLYHeader & get_header() const {return header_;};
+        inline size_t num_vertices() const {return num_vertices_;};
+        inline size_t num_faces() const {return faces_.cols();};
+        inline bool has_normals() const {return normal_offset_ >= 0;};
+        inline bool has_colors() const {return color_offset_ >= 0;};
+        inline bool has_vertex_views() const {return is_float_aligned(position_offset_);};
+        inline bool has_normal_views() const {return has_normals() && is_float_aligned(normal_offset_);};
+
+        // views over the mapped file, valid as long as this object is alive
+        inline ConstMap3Xf vertices() const {
+            if (!has_vertex_views())
+                throw std::runtime_error("the vertex positions are not float aligned, use get_vertices");
+            return float_view(position_offset_);
+        };
+
+        inline ConstMap3Xf normals() const {
+            if (!has_normal_views())
+                throw std::runtime_error("the PLY file has no float aligned nx, ny, nz properties, use get_normals");
+            return float_view(normal_offset_);
+        };
+
+        // vertex attributes copied from the mapped file, one column per vertex
+        inline void get_vertices(Eigen::MatrixXd & V) const {
+            get_floats(position_offset_, V);
+        };
+
+        inline void get_normals(Eigen::MatrixXd & N) const {
+            if (!has_normals())
+                throw std::runtime_error("the PLY file has no float32 nx, ny, nz properties");
+            get_floats(normal_offset_, N);
+        };
+
+        inline void get_colors(Eigen::MatrixXi & RGB) const {
+            if (!has_colors())
+                throw std::runtime_error("the PLY file has no uchar red, green, blue properties");
+            RGB.resize(3, num_vertices_);
+            #pragma omp parallel for
+            for (long int i=0; i<long(num_vertices_); i++) {
+                const uint8_t * record = reinterpret_cast<const uint8_t *>(vertex_data_ + i*vertex_stride_ + color_offset_);
+                RGB.col(i) << record[0], record[1], record[2];
+            }
+        };
+
+        inline const Eigen::Matrix<int, 3, Eigen::Dynamic> & faces() const {return faces_;};
+
+    private:
+
+        inline bool is_float_aligned(int offset) const {
+            return vertex_stride_ % sizeof(float) == 0 && reinterpret_cast<uintptr_t>(vertex_data_ + offset) % sizeof(float) == 0;
+        };
+
+        inline ConstMap3Xf float_view(int offset) const {
+            return ConstMap3Xf(reinterpret_cast<const float *>(vertex_data_ + offset), 3, num_vertices_, Eigen::OuterStride<>(vertex_stride_/sizeof(float)));
+        };
+
+        // three float32 starting at offset in every vertex record, through the
+        // view when the records are float aligned and with memcpy otherwise
+        inline void get_floats(int offset, Eigen::MatrixXd & values) const {
+            values.resize(3, num_vertices_);
+            if (is_float_aligned(offset)) {
+                const ConstMap3Xf view = float_view(offset);
+                #pragma omp parallel for
+                for (long int i=0; i<long(num_vertices_); i++)
+                    values.col(i) = view.col(i).cast<double>();
+                return;
+            }
+
+            #pragma omp parallel for
+            for (long int i=0; i<long(num_vertices_); i++) {
+                float record[3];
+                std::memcpy(record, vertex_data_ + i*vertex_stride_ + offset, sizeof(record));
+                values.col(i) << record[0], record[1], record[2];
+            }
+        };
+};
+
+#endif
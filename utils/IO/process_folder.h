@@ -11,6 +11,8 @@
 #include <stdio.h>
 #include <dirent.h>
 #include <string>
+#include <vector>
+#include <algorithm>
 
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -57,4 +59,29 @@ inline bool create_folder(std::string folder_path) {
     return true;
 }
 
+// paths of the files of a folder ending with extension (e.g. ".ply"), sorted by name
+inline std::vector< std::string > list_files(std::string folder_path, std::string extension) {
+    std::vector< std::string > files;
+    if (!folder_path.empty() && folder_path[folder_path.size() - 1] != '/')
+        folder_path += "/";
+
+    DIR *theFolder = opendir(folder_path.c_str());
+    if (theFolder == NULL) {
+        std::cout << "Error: the folder does not exist\n";
+        return files;
+    }
+
+    struct dirent *next_file;
+    while ( (next_file = readdir(theFolder)) != NULL )
+    {
+        std::string file_name = next_file->d_name;
+        if (file_name.size() > extension.size() && file_name.substr(file_name.size() - extension.size()) == extension)
+            files.push_back(folder_path + file_name);
+    }
+    closedir(theFolder);
+
+    std::sort(files.begin(), files.end());
+    return files;
+};
+
 #endif
@@ -0,0 +1,94 @@
+/*
+*   read a PGM image (e.g. a 16 bits depth map)
+*   by R. Falque
+*   18/10/2026
+*/
+
+#ifndef READ_PGM_H
+#define READ_PGM_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cctype>
+#include <cstdlib>
+
+#include <Eigen/Core>
+
+// next header token, skipping the whitespaces and the comments
+inline bool read_PGM_token(std::istream & stream, std::string & token) {
+    token.clear();
+    int c = stream.get();
+    while (stream.good()) {
+        if (c == '#')
+            while (stream.good() && c != '\n')
+                c = stream.get();
+        else if (std::isspace(c))
+            c = stream.get();
+        else
+            break;
+    }
+    while (stream.good() && !std::isspace(c)) {
+        token += char(c);
+        c = stream.get();
+    }
+    return !token.empty();
+};
+
+// Read a binary (P5) or ascii (P2) PGM file, the values are scaled by scale
+// (e.g. 0.001 for a depth map in millimeters). Row 0 of image is the top row
+// of the file, as in the pinhole camera convention (v pointing down).
+inline bool readPGM(const std::string filename, Eigen::MatrixXf & image, double scale = 1.0) {
+    std::ifstream file(filename.c_str(), std::ios::binary);
+    if (!file.is_open()) {
+        std::cout << "Error: could not open " << filename << std::endl;
+        return false;
+    }
+
+    std::string magic, token;
+    int width, height, max_value;
+    if (!read_PGM_token(file, magic) || (magic != "P5" && magic != "P2")) {
+        std::cout << "Error: " << filename << " is not a PGM file" << std::endl;
+        return false;
+    }
+    read_PGM_token(file, token); width = std::atoi(token.c_str());
+    read_PGM_token(file, token); height = std::atoi(token.c_str());
+    read_PGM_token(file, token); max_value = std::atoi(token.c_str());
+    if (width <= 0 || height <= 0 || max_value <= 0 || max_value > 65535) {
+        std::cout << "Error: invalid PGM header in " << filename << std::endl;
+        return false;
+    }
+
+    image.resize(height, width);
+    if (magic == "P2") {
+        for (int v = 0; v < height; ++v)
+            for (int u = 0; u < width; ++u) {
+                if (!read_PGM_token(file, token)) {
+                    std::cout << "Error: truncated PGM file " << filename << std::endl;
+                    return false;
+                }
+                image(v, u) = float(std::atoi(token.c_str()) * scale);
+            }
+        return true;
+    }
+
+    // binary values, 16 bits ones are big endian
+    const int bytes = max_value < 256 ? 1 : 2;
+    std::vector< unsigned char > data(long(width) * height * bytes);
+    file.read(reinterpret_cast<char *>(&data[0]), data.size());
+    if (file.gcount() != std::streamsize(data.size())) {
+        std::cout << "Error: truncated PGM file " << filename << std::endl;
+        return false;
+    }
+    for (int v = 0; v < height; ++v)
+        for (int u = 0; u < width; ++u) {
+            const long int i = (long(v) * width + u) * bytes;
+            const int value = bytes == 1 ? data[i] : (data[i] << 8) | data[i + 1];
+            image(v, u) = float(value * scale);
+        }
+
+    return true;
+};
+
+#endif
@@ -9,6 +9,8 @@
 #define TINYPLY_IMPLEMENTATION
 #include "tinyply.h"
 #include "structures.h"
+#include "mappedPLY.h"
+#include "readPLYAscii.h"
 
 using namespace tinyply;
 
@@ -22,6 +24,46 @@ void readPLY(const std::string & filepath,
 
 	try
 	{
+        // ascii files go through the parallel parser and binary little endian
+        // ones through the mapped reader, tinyply is kept for the other ones
+        // and for the files the two fast readers fail to parse
+        PLYFormat format = PLY_BINARY_BIG_ENDIAN;
+        {
+            MappedFile mapped_file(filepath);
+            PLYHeader header;
+            bool is_ascii = false;
+            try { header = parse_ply_header(mapped_file.data(), mapped_file.size()); is_ascii = (header.format == PLY_ASCII); format = header.format; }
+            catch (const std::exception & e) { is_ascii = false; }
+
+            if (is_ascii) {
+                // parsed into temporaries, so that a failure leaves the outputs to tinyply
+                try {
+                    Eigen::MatrixXd V_ascii, N_ascii;
+                    Eigen::MatrixXi F_ascii, RGB_ascii;
+                    readPLY_ascii(mapped_file, header, V_ascii, F_ascii, N_ascii, RGB_ascii);
+                    V.swap(V_ascii); F.swap(F_ascii); N.swap(N_ascii); RGB.swap(RGB_ascii);
+                    return;
+                }
+                catch (const std::exception & e) {
+                    if (verbose) std::cout << "ascii PLY reader: " << e.what() << ", falling back to tinyply\n";
+                }
+            }
+        }
+
+        if (format == PLY_BINARY_LITTLE_ENDIAN) {
+            try {
+                MappedPLY mapped_ply(filepath);
+                mapped_ply.get_vertices(V);
+                if (mapped_ply.has_normals()) mapped_ply.get_normals(N);
+                if (mapped_ply.has_colors())  mapped_ply.get_colors(RGB);
+                if (mapped_ply.num_faces() > 0) F = mapped_ply.faces();
+                return;
+            }
+            catch (const std::exception & e) {
+                if (verbose) std::cout << "mapped PLY reader: " << e.what() << ", falling back to tinyply\n";
+            }
+        }
+
 		std::ifstream ss(filepath, std::ios::binary);
 		if (ss.fail()) throw std::runtime_error("failed to open " + filepath);
 
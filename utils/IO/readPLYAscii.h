@@ -0,0 +1,269 @@
+/*
+*   parallel parser for ascii PLY files
+*   by R. Falque
+*   18/10/2026
+*/
+
+#ifndef IO_READPLYASCII_H
+#define IO_READPLYASCII_H
+
+#include <vector>
+#include <string>
+#include <cmath>
+#include <stdexcept>
+#include <Eigen/Core>
+
+#include "mappedPLY.h"
+
+// bytes of body handled by one parsing task
+#define PLY_ASCII_CHUNK_SIZE (1 << 20)
+
+inline bool is_ply_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+};
+
+// Parse a decimal number starting at p and move p after it. std::from_chars
+// would do the job but needs C++17, so this is the bounded equivalent: the
+// mantissa is accumulated as an integer and scaled once, which is exact for
+// the usual PLY precision (up to 15 significant digits and |exponent| <= 22).
+inline bool parse_ply_number(const char * & p, const char * end, double & value) {
+    static const double powers_of_ten[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+    while (p < end && is_ply_blank(*p))
+        p++;
+
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        p++;
+    }
+
+    unsigned long long mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+    bool has_digits = false;
+
+    while (p < end && *p >= '0' && *p <= '9') {
+        if (digits < 19) {
+            mantissa = mantissa*10 + (*p - '0');
+            if (mantissa != 0) digits++;
+        } else {
+            exponent++;
+        }
+        has_digits = true;
+        p++;
+    }
+
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (digits < 19) {
+                mantissa = mantissa*10 + (*p - '0');
+                if (mantissa != 0) digits++;
+                exponent--;
+            }
+            has_digits = true;
+            p++;
+        }
+    }
+
+    if (!has_digits)
+        return false;
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool negative_exponent = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negative_exponent = (*p == '-');
+            p++;
+        }
+        if (p == end || *p < '0' || *p > '9')
+            return false;
+        int explicit_exponent = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (explicit_exponent < 10000)
+                explicit_exponent = explicit_exponent*10 + (*p - '0');
+            p++;
+        }
+        exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+    }
+
+    value = double(mantissa);
+    if (exponent < 0 && exponent >= -22)
+        value /= powers_of_ten[-exponent];
+    else if (exponent > 0 && exponent <= 22)
+        value *= powers_of_ten[exponent];
+    else if (exponent != 0)
+        value *= std::pow(10.0, exponent);
+
+    if (negative)
+        value = -value;
+
+    return true;
+};
+
+// Parse the body of an ascii PLY file in parallel. The body is cut into
+// chunks at line boundaries, a first pass counts the lines of each chunk and
+// the prefix sum of these counts gives the element index of every line, so
+// the second pass writes each vertex and face directly at its final place.
+inline void readPLY_ascii(const MappedFile & file,
+                          const PLYHeader & header,
+                          Eigen::MatrixXd &V,
+                          Eigen::MatrixXi &F,
+                          Eigen::MatrixXd &N,
+                          Eigen::MatrixXi &RGB)
+{
+    if (header.format != PLY_ASCII)
+        throw std::runtime_error("readPLY_ascii called on a binary PLY file");
+
+    const char * begin = file.data() + header.body_offset;
+    const char * end = file.data() + file.size();
+
+    // line ranges of each element
+    std::vector<size_t> element_first_line(header.elements.size() + 1, 0);
+    for (size_t i=0; i<header.elements.size(); i++)
+        element_first_line[i+1] = element_first_line[i] + header.elements[i].count;
+
+    int vertex_id = -1, face_id = -1;
+    for (size_t i=0; i<header.elements.size(); i++) {
+        if (header.elements[i].name == "vertex") vertex_id = i;
+        if (header.elements[i].name == "face")   face_id = i;
+    }
+
+    // column of each vertex property in the output (0-2: V, 3-5: N, 6-8: RGB, -1: skipped)
+    std::vector<int> vertex_columns;
+    bool has_positions = false, has_normals = false, has_rgb = false;
+    if (vertex_id >= 0) {
+        const PLYElement & vertex = header.elements[vertex_id];
+        const char * names[] = { "x", "y", "z", "nx", "ny", "nz", "red", "green", "blue" };
+        int found[9];
+        for (int i=0; i<9; i++)
+            found[i] = vertex.find(names[i]);
+
+        has_positions = found[0] >= 0 && found[1] >= 0 && found[2] >= 0;
+        has_normals   = found[3] >= 0 && found[4] >= 0 && found[5] >= 0;
+        has_rgb       = found[6] >= 0 && found[7] >= 0 && found[8] >= 0;
+
+        vertex_columns.assign(vertex.properties.size(), -1);
+        for (int i=0; i<9; i++) {
+            bool used = (i < 3 && has_positions) || (i >= 3 && i < 6 && has_normals) || (i >= 6 && has_rgb);
+            if (used)
+                vertex_columns[found[i]] = i;
+        }
+    }
+
+    if (face_id >= 0) {
+        const PLYElement & face = header.elements[face_id];
+        if (face.properties.size() != 1 || !face.properties[0].is_list)
+            throw std::runtime_error("faces must be a single list property");
+    }
+
+    // split the body into chunks that start at the beginning of a line
+    std::vector<const char *> chunk_begin;
+    chunk_begin.push_back(begin);
+    while (true) {
+        const char * split = chunk_begin.back() + PLY_ASCII_CHUNK_SIZE;
+        if (split >= end)
+            break;
+        while (split < end && *split != '\n')
+            split++;
+        if (split >= end - 1)
+            break;
+        chunk_begin.push_back(split + 1);
+    }
+    chunk_begin.push_back(end);
+    long int num_chunks = chunk_begin.size() - 1;
+
+    // first pass: count the non empty lines of each chunk
+    std::vector<size_t> chunk_first_line(num_chunks + 1, 0);
+    #pragma omp parallel for
+    for (long int c=0; c<num_chunks; c++) {
+        size_t lines = 0;
+        bool blank = true;
+        for (const char * p = chunk_begin[c]; p < chunk_begin[c+1]; p++) {
+            if (*p == '\n') {
+                if (!blank) lines++;
+                blank = true;
+            } else if (!is_ply_blank(*p)) {
+                blank = false;
+            }
+        }
+        if (!blank) lines++;
+        chunk_first_line[c+1] = lines;
+    }
+    for (long int c=0; c<num_chunks; c++)
+        chunk_first_line[c+1] += chunk_first_line[c];
+
+    if (chunk_first_line[num_chunks] < element_first_line.back())
+        throw std::runtime_error("the ascii PLY body has fewer lines than declared in the header");
+
+    if (has_positions) V.resize(3, header.elements[vertex_id].count);
+    if (has_normals)   N.resize(3, header.elements[vertex_id].count);
+    if (has_rgb)       RGB.resize(3, header.elements[vertex_id].count);
+    if (face_id >= 0)  F.resize(3, header.elements[face_id].count);
+
+    // second pass: parse every line at the index given by the prefix sum
+    std::vector<int> chunk_status(num_chunks, 0);     // 0: ok, 1: malformed number, 2: non triangle face
+    #pragma omp parallel for
+    for (long int c=0; c<num_chunks; c++) {
+        size_t line = chunk_first_line[c];
+        const char * p = chunk_begin[c];
+        const char * chunk_end = chunk_begin[c+1];
+        double value;
+
+        while (p < chunk_end && chunk_status[c] == 0) {
+            const char * line_end = p;
+            while (line_end < chunk_end && *line_end != '\n')
+                line_end++;
+
+            const char * q = p;
+            while (q < line_end && is_ply_blank(*q))
+                q++;
+
+            if (q < line_end) {
+                if (vertex_id >= 0 && line >= element_first_line[vertex_id] && line < element_first_line[vertex_id+1]) {
+                    size_t i = line - element_first_line[vertex_id];
+                    for (size_t k=0; k<vertex_columns.size(); k++) {
+                        if (!parse_ply_number(q, line_end, value)) {
+                            chunk_status[c] = 1;
+                            break;
+                        }
+                        switch (vertex_columns[k]) {
+                            case 0: case 1: case 2: V(vertex_columns[k], i) = value;        break;
+                            case 3: case 4: case 5: N(vertex_columns[k] - 3, i) = value;    break;
+                            case 6: case 7: case 8: RGB(vertex_columns[k] - 6, i) = int(value); break;
+                            default: break;
+                        }
+                    }
+                } else if (face_id >= 0 && line >= element_first_line[face_id] && line < element_first_line[face_id+1]) {
+                    size_t i = line - element_first_line[face_id];
+                    if (!parse_ply_number(q, line_end, value)) {
+                        chunk_status[c] = 1;
+                    } else if (value != 3) {
+                        chunk_status[c] = 2;
+                    } else {
+                        for (int k=0; k<3; k++) {
+                            if (!parse_ply_number(q, line_end, value)) {
+                                chunk_status[c] = 1;
+                                break;
+                            }
+                            F(k, i) = int(value);
+                        }
+                    }
+                }
+                line++;
+            }
+
+            p = line_end + 1;
+        }
+    }
+
+    for (long int c=0; c<num_chunks; c++) {
+        if (chunk_status[c] == 1) throw std::runtime_error("malformed number in the ascii PLY body");
+        if (chunk_status[c] == 2) throw std::runtime_error("the ascii PLY file contains faces which are not triangles");
+    }
+};
+
+#endif
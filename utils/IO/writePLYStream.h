@@ -0,0 +1,189 @@
+/*
+*   streaming binary PLY writer (no intermediate geometry copy)
+*   by R. Falque
+*   18/10/2026
+*/
+
+#ifndef IO_WRITEPLYSTREAM_H
+#define IO_WRITEPLYSTREAM_H
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <functional>
+#include <algorithm>
+#include <stdint.h>
+#include <Eigen/Core>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "structures.h"
+
+// bytes of records serialized by one writing task
+#define PLY_STREAM_BLOCK_SIZE (4 << 20)
+
+// generators called with a record index, they can be called concurrently
+typedef std::function<void (size_t i, float3 & position, float3 & normal, uchar3 & rgb)> PLYVertexGenerator;
+typedef std::function<void (size_t i, uint3 & face)> PLYFaceGenerator;
+
+inline bool pwrite_all(int fd, const char * data, size_t size, off_t offset) {
+    while (size > 0) {
+        ssize_t written = pwrite(fd, data, size, offset);
+        if (written <= 0)
+            return false;
+        data += written;
+        size -= written;
+        offset += written;
+    }
+    return true;
+};
+
+// Write a binary little endian PLY file whose records are produced on the fly.
+// The size of every record is known up front, so the file is split into
+// blocks at precomputed offsets which are serialized and written with pwrite
+// in parallel; peak memory is one block per thread instead of a full copy.
+inline void writePLY_stream(const std::string & filepath,
+                            size_t num_vertices,
+                            size_t num_faces,
+                            bool has_normals,
+                            bool has_rgb,
+                            const PLYVertexGenerator & vertex_generator,
+                            const PLYFaceGenerator & face_generator)
+{
+    uint16_t endian_probe = 1;
+    if (*reinterpret_cast<uint8_t *>(&endian_probe) != 1)
+        throw std::runtime_error("writePLY_stream only supports little endian hosts");
+
+    if (num_vertices == 0)
+        throw std::invalid_argument("asked to write a set of empty vertices");
+
+    std::stringstream header;
+    header << "ply\n";
+    header << "format binary_little_endian 1.0\n";
+    header << "comment generated by writePLY_stream\n";
+    header << "element vertex " << num_vertices << "\n";
+    header << "property float x\nproperty float y\nproperty float z\n";
+    if (has_normals)
+        header << "property float nx\nproperty float ny\nproperty float nz\n";
+    if (has_rgb)
+        header << "property uchar red\nproperty uchar green\nproperty uchar blue\n";
+    if (num_faces != 0) {
+        header << "element face " << num_faces << "\n";
+        header << "property list uchar uint vertex_indices\n";
+    }
+    header << "end_header\n";
+    std::string header_string = header.str();
+
+    const size_t vertex_record = sizeof(float3) + (has_normals ? sizeof(float3) : 0) + (has_rgb ? sizeof(uchar3) : 0);
+    const size_t face_record = 1 + sizeof(uint3);
+    const size_t vertex_offset = header_string.size();
+    const size_t face_offset = vertex_offset + vertex_record * num_vertices;
+    const size_t file_size = face_offset + face_record * num_faces;
+
+    int fd = open(filepath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) throw std::runtime_error("failed to open " + filepath);
+
+    bool success = (ftruncate(fd, file_size) == 0);
+    success = success && pwrite_all(fd, header_string.data(), header_string.size(), 0);
+
+    // vertex blocks first, then face blocks, all independent
+    const size_t vertices_per_block = PLY_STREAM_BLOCK_SIZE / vertex_record;
+    const size_t faces_per_block = PLY_STREAM_BLOCK_SIZE / face_record;
+    const long int num_vertex_blocks = (num_vertices + vertices_per_block - 1) / vertices_per_block;
+    const long int num_face_blocks = (num_faces + faces_per_block - 1) / faces_per_block;
+    std::vector<char> block_status(num_vertex_blocks + num_face_blocks, success);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (long int b=0; b<num_vertex_blocks + num_face_blocks; b++) {
+        if (!block_status[b])
+            continue;
+
+        std::vector<char> buffer;
+        float3 position, normal = {0, 0, 0};
+        uchar3 rgb = {0, 0, 0};
+        uint3 face;
+
+        if (b < num_vertex_blocks) {
+            size_t first = b * vertices_per_block;
+            size_t last = std::min(first + vertices_per_block, num_vertices);
+            buffer.resize((last - first) * vertex_record);
+
+            char * record = buffer.data();
+            for (size_t i=first; i<last; i++) {
+                vertex_generator(i, position, normal, rgb);
+                std::memcpy(record, &position, sizeof(float3));
+                record += sizeof(float3);
+                if (has_normals) {
+                    std::memcpy(record, &normal, sizeof(float3));
+                    record += sizeof(float3);
+                }
+                if (has_rgb) {
+                    std::memcpy(record, &rgb, sizeof(uchar3));
+                    record += sizeof(uchar3);
+                }
+            }
+            block_status[b] = pwrite_all(fd, buffer.data(), buffer.size(), vertex_offset + first * vertex_record);
+        } else {
+            size_t first = (b - num_vertex_blocks) * faces_per_block;
+            size_t last = std::min(first + faces_per_block, num_faces);
+            buffer.resize((last - first) * face_record);
+
+            char * record = buffer.data();
+            for (size_t i=first; i<last; i++) {
+                face_generator(i, face);
+                record[0] = 3;
+                std::memcpy(record + 1, &face, sizeof(uint3));
+                record += face_record;
+            }
+            block_status[b] = pwrite_all(fd, buffer.data(), buffer.size(), face_offset + first * face_record);
+        }
+    }
+
+    for (long int b=0; b<block_status.size(); b++)
+        success = success && block_status[b];
+
+    success = (close(fd) == 0) && success;
+    if (!success)
+        throw std::runtime_error("failed to write " + filepath);
+};
+
+// same outputs as writePLY(..., false) but streamed straight from the matrices
+inline void writePLY_stream(const std::string & filepath,
+                            const Eigen::MatrixXd &V,
+                            const Eigen::MatrixXi &F,
+                            const Eigen::MatrixXd &N,
+                            const Eigen::MatrixXi &RGB)
+{
+    const bool has_normals = (N.cols() == V.cols());
+    const bool has_rgb = (RGB.cols() == V.cols());
+
+    PLYVertexGenerator vertex_generator = [&](size_t i, float3 & position, float3 & normal, uchar3 & rgb) {
+        position.x = V(0,i); position.y = V(1,i); position.z = V(2,i);
+        if (has_normals) {
+            normal.x = N(0,i); normal.y = N(1,i); normal.z = N(2,i);
+        }
+        if (has_rgb) {
+            rgb.r = RGB(0,i); rgb.g = RGB(1,i); rgb.b = RGB(2,i);
+        }
+    };
+
+    PLYFaceGenerator face_generator = [&](size_t i, uint3 & face) {
+        face.x = F(0,i); face.y = F(1,i); face.z = F(2,i);
+    };
+
+    writePLY_stream(filepath, V.cols(), F.cols(), has_normals, has_rgb, vertex_generator, face_generator);
+};
+
+inline void writePLY_stream(const std::string & filepath,
+                            const Eigen::MatrixXd &V,
+                            const Eigen::MatrixXi &F)
+{
+    Eigen::MatrixXd N;
+    Eigen::MatrixXi RGB;
+    writePLY_stream(filepath, V, F, N, RGB);
+};
+
+#endif
@@ -0,0 +1,176 @@
+/*
+*   three stages pipeline (load, compute, write) over a batch of files
+*   by R. Falque
+*   18/10/2026
+*/
+
+#ifndef BATCH_PIPELINE_H
+#define BATCH_PIPELINE_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// queue with a maximum size: push blocks while it is full and pop while it
+// is empty, until the queue is closed
+template <typename T>
+class BoundedQueue
+{
+    private:
+        std::deque<T> items_;
+        size_t capacity_;
+        bool closed_;
+        std::mutex mutex_;
+        std::condition_variable not_empty_, not_full_;
+
+    public:
+
+        BoundedQueue(size_t capacity) : capacity_(std::max<size_t>(capacity, 1)), closed_(false) {}
+
+        // false if the queue was closed, the item is then dropped
+        inline bool push(T item) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_full_.wait(lock, [this]() {return closed_ || items_.size() < capacity_;});
+            if (closed_)
+                return false;
+            items_.push_back(std::move(item));
+            not_empty_.notify_one();
+            return true;
+        };
+
+        // false once the queue is closed and empty
+        inline bool pop(T & item) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_empty_.wait(lock, [this]() {return closed_ || !items_.empty();});
+            if (items_.empty())
+                return false;
+            item = std::move(items_.front());
+            items_.pop_front();
+            not_full_.notify_one();
+            return true;
+        };
+
+        inline void close() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+            not_empty_.notify_all();
+            not_full_.notify_all();
+        };
+};
+
+// run one stage of a job, an exception counts as a failure of the job
+template <typename Stage>
+inline bool run_stage(const std::string & description, Stage stage) {
+    try {
+        return stage();
+    } catch (const std::exception & e) {
+        std::cout << "Error: " << description << " failed: " << e.what() << std::endl;
+    } catch (...) {
+        std::cout << "Error: " << description << " failed" << std::endl;
+    }
+    return false;
+};
+
+// Run load, compute and write over a batch of files, each file being a Job
+// going through the three stages in turn, so that the stages of different
+// files overlap: load_threads threads read the next files while the
+// current one is computed, and write_threads threads export the previous
+// ones. The queues between the stages hold at most capacity jobs, which
+// bounds the memory in use. The load and write threads use a single OpenMP
+// thread each (they are parallel over the files instead), and the compute
+// stage runs on the calling thread with an OpenMP team reduced by the
+// number of load and write threads (at least one thread), so that the
+// stages share the cores. A stage returning false or throwing drops the
+// job. Returns the number of files written.
+template <typename Job>
+inline int run_batch_pipeline(const std::vector< std::string > & files,
+                              std::function< bool (const std::string &, Job &) > load,
+                              std::function< bool (Job &) > compute,
+                              std::function< bool (Job &) > write,
+                              int load_threads = 2, int write_threads = 2, int capacity = 2)
+{
+    typedef std::shared_ptr<Job> JobPointer;
+    load_threads = std::max(1, load_threads);
+    write_threads = std::max(1, write_threads);
+    BoundedQueue<JobPointer> loaded(capacity), computed(capacity);
+    std::atomic<int> next_file(0), running_loaders(load_threads), written(0);
+    std::vector< std::thread > threads;
+
+    #ifdef _OPENMP
+    const int compute_threads = omp_get_max_threads();
+    omp_set_num_threads(std::max(1, compute_threads - load_threads - write_threads));
+    #endif
+
+    try {
+        for (int t = 0; t < load_threads; ++t)
+            threads.push_back(std::thread([&]() {
+                #ifdef _OPENMP
+                omp_set_num_threads(1);
+                #endif
+                for (int i = next_file++; i < int(files.size()); i = next_file++) {
+                    JobPointer job;
+                    const bool success = run_stage("loading " + files[i], [&]() {
+                        job = std::make_shared<Job>();
+                        return load(files[i], *job);
+                    });
+                    if (success)
+                        loaded.push(job);
+                    else
+                        std::cout << "Error: could not load " << files[i] << std::endl;
+                }
+                if (--running_loaders == 0)
+                    loaded.close();
+            }));
+
+        for (int t = 0; t < write_threads; ++t)
+            threads.push_back(std::thread([&]() {
+                #ifdef _OPENMP
+                omp_set_num_threads(1);
+                #endif
+                JobPointer job;
+                while (computed.pop(job)) {
+                    if (run_stage("writing a job", [&]() {return write(*job);}))
+                        written++;
+                    job.reset();
+                }
+            }));
+
+        JobPointer job;
+        while (loaded.pop(job)) {
+            if (run_stage("computing a job", [&]() {return compute(*job);}))
+                computed.push(job);
+            job.reset();
+        }
+    } catch (const std::exception & e) {
+        // only the creation of the threads can throw here, the stages catch their own exceptions
+        std::cout << "Error: the batch was interrupted: " << e.what() << std::endl;
+    }
+
+    // stop every stage and wait for the threads, whatever happened above
+    next_file = int(files.size());
+    loaded.close();
+    computed.close();
+    for (int t = 0; t < threads.size(); ++t)
+        threads[t].join();
+
+    #ifdef _OPENMP
+    omp_set_num_threads(compute_threads);
+    #endif
+
+    return written;
+};
+
+#endif
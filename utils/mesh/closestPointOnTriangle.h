@@ -0,0 +1,55 @@
+/*
+*   closest point of a triangle to a query point
+*   by R. Falque
+*   18/10/2026
+*/
+
+#ifndef CLOSEST_POINT_ON_TRIANGLE_H
+#define CLOSEST_POINT_ON_TRIANGLE_H
+
+#include <Eigen/Dense>
+
+// Barycentric coordinates of the point of the triangle (a, b, c) closest to
+// p, found by testing the Voronoi regions of the vertices, then of the
+// edges, then the face (Ericson, Real-Time Collision Detection, 5.1.5).
+inline Eigen::Vector3d closest_point_on_triangle(const Eigen::Vector3d & p, const Eigen::Vector3d & a, const Eigen::Vector3d & b, const Eigen::Vector3d & c)
+{
+    const Eigen::Vector3d ab = b - a, ac = c - a, ap = p - a;
+    const double d1 = ab.dot(ap), d2 = ac.dot(ap);
+    if (d1 <= 0 && d2 <= 0)
+        return Eigen::Vector3d(1, 0, 0);
+
+    const Eigen::Vector3d bp = p - b;
+    const double d3 = ab.dot(bp), d4 = ac.dot(bp);
+    if (d3 >= 0 && d4 <= d3)
+        return Eigen::Vector3d(0, 1, 0);
+
+    const double vc = d1*d4 - d3*d2;
+    if (vc <= 0 && d1 >= 0 && d3 <= 0) {
+        const double v = d1 / (d1 - d3);
+        return Eigen::Vector3d(1 - v, v, 0);
+    }
+
+    const Eigen::Vector3d cp = p - c;
+    const double d5 = ab.dot(cp), d6 = ac.dot(cp);
+    if (d6 >= 0 && d5 <= d6)
+        return Eigen::Vector3d(0, 0, 1);
+
+    const double vb = d5*d2 - d1*d6;
+    if (vb <= 0 && d2 >= 0 && d6 <= 0) {
+        const double w = d2 / (d2 - d6);
+        return Eigen::Vector3d(1 - w, 0, w);
+    }
+
+    const double va = d3*d6 - d5*d4;
+    if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0) {
+        const double w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        return Eigen::Vector3d(0, 1 - w, w);
+    }
+
+    const double denominator = 1.0 / (va + vb + vc);
+    const double v = vb * denominator, w = vc * denominator;
+    return Eigen::Vector3d(1 - v - w, v, w);
+};
+
+#endif
@@ -0,0 +1,83 @@
+/*
+*   compute the faces' centroids, normals, areas and the mesh bounds in one pass
+*   by R. Falque
+*   18/10/2026
+*/
+
+#ifndef COMPUTE_FACES_ATTRIBUTES_H
+#define COMPUTE_FACES_ATTRIBUTES_H
+
+#include <cmath>
+#include <limits>
+#include <Eigen/Dense>
+
+// structure of arrays: each row of centroids and normals is contiguous
+struct FacesAttributes
+{
+    Eigen::Matrix<float, 3, Eigen::Dynamic, Eigen::RowMajor> centroids;
+    Eigen::Matrix<float, 3, Eigen::Dynamic, Eigen::RowMajor> normals;
+    Eigen::VectorXf areas;
+    Eigen::Vector3d min_point;
+    Eigen::Vector3d max_point;
+};
+
+// Single pass over the faces producing everything the voxelizers need from a
+// mesh. The outputs are only resized when their size changes, so they can be
+// preallocated and reused across meshes.
+inline void compute_faces_attributes(const Eigen::MatrixXd & V, const Eigen::MatrixXi & F, FacesAttributes & attributes) {
+    const long int num_faces = F.cols();
+
+    if (attributes.centroids.cols() != num_faces) {
+        attributes.centroids.resize(3, num_faces);
+        attributes.normals.resize(3, num_faces);
+        attributes.areas.resize(num_faces);
+    }
+
+    const double * vertices = V.data();
+    const int * faces = F.data();
+    float * cx = attributes.centroids.row(0).data();
+    float * cy = attributes.centroids.row(1).data();
+    float * cz = attributes.centroids.row(2).data();
+    float * nx = attributes.normals.row(0).data();
+    float * ny = attributes.normals.row(1).data();
+    float * nz = attributes.normals.row(2).data();
+    float * areas = attributes.areas.data();
+
+    double min_x =  std::numeric_limits<double>::max(), min_y = min_x, min_z = min_x;
+    double max_x = -std::numeric_limits<double>::max(), max_y = max_x, max_z = max_x;
+
+    #pragma omp parallel for reduction(min:min_x,min_y,min_z) reduction(max:max_x,max_y,max_z)
+    for (long int i=0; i<num_faces; i++) {
+        const double * a = vertices + 3*faces[3*i+0];
+        const double * b = vertices + 3*faces[3*i+1];
+        const double * c = vertices + 3*faces[3*i+2];
+
+        double e1_x = b[0] - a[0], e1_y = b[1] - a[1], e1_z = b[2] - a[2];
+        double e2_x = c[0] - a[0], e2_y = c[1] - a[1], e2_z = c[2] - a[2];
+        double n_x = e1_y*e2_z - e1_z*e2_y;
+        double n_y = e1_z*e2_x - e1_x*e2_z;
+        double n_z = e1_x*e2_y - e1_y*e2_x;
+        double norm = std::sqrt(n_x*n_x + n_y*n_y + n_z*n_z);
+        double inv_norm = norm > 0 ? 1.0/norm : 0.0;
+
+        cx[i] = (a[0] + b[0] + c[0]) / 3;
+        cy[i] = (a[1] + b[1] + c[1]) / 3;
+        cz[i] = (a[2] + b[2] + c[2]) / 3;
+        nx[i] = n_x * inv_norm;
+        ny[i] = n_y * inv_norm;
+        nz[i] = n_z * inv_norm;
+        areas[i] = 0.5 * norm;
+
+        min_x = std::min(min_x, std::min(a[0], std::min(b[0], c[0])));
+        min_y = std::min(min_y, std::min(a[1], std::min(b[1], c[1])));
+        min_z = std::min(min_z, std::min(a[2], std::min(b[2], c[2])));
+        max_x = std::max(max_x, std::max(a[0], std::max(b[0], c[0])));
+        max_y = std::max(max_y, std::max(a[1], std::max(b[1], c[1])));
+        max_z = std::max(max_z, std::max(a[2], std::max(b[2], c[2])));
+    }
+
+    attributes.min_point << min_x, min_y, min_z;
+    attributes.max_point << max_x, max_y, max_z;
+};
+
+#endif
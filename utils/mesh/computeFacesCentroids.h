@@ -10,9 +10,10 @@
 #include <iostream>
 #include <Eigen/Dense>
 
-inline Eigen::MatrixXd compute_faces_centroids(Eigen::MatrixXd V, Eigen::MatrixXi F) {
-    Eigen::MatrixXd F_centroids = Eigen::MatrixXd::Zero(3, F.cols());
+inline Eigen::MatrixXd compute_faces_centroids(const Eigen::MatrixXd & V, const Eigen::MatrixXi & F) {
+    Eigen::MatrixXd F_centroids(3, F.cols());
     
+    #pragma omp parallel for
     for (int i=0; i<F.cols(); i++)
         F_centroids.col(i) = ( V.col(F(0,i)) + V.col(F(1,i)) + V.col(F(2,i)) ) / 3;
 
@@ -10,7 +10,7 @@
 #include <iostream>
 #include <Eigen/Dense>
 
-inline Eigen::MatrixXd compute_vertices_normals(Eigen::MatrixXd V, Eigen::MatrixXi F) {
+inline Eigen::MatrixXd compute_vertices_normals(const Eigen::MatrixXd & V, const Eigen::MatrixXi & F) {
     Eigen::MatrixXd normals = Eigen::MatrixXd::Zero(3, V.cols());
     Eigen::Vector3d normal_temp, v1, v2;
 
@@ -37,11 +37,12 @@ inline Eigen::MatrixXd compute_vertices_normals(Eigen::MatrixXd V, Eigen::Matrix
     return normals;
 };
 
-inline Eigen::MatrixXd compute_faces_normals(Eigen::MatrixXd V, Eigen::MatrixXi F) {
-    Eigen::MatrixXd normals = Eigen::MatrixXd::Zero(3, F.cols());
-    Eigen::Vector3d v1, v2;
+inline Eigen::MatrixXd compute_faces_normals(const Eigen::MatrixXd & V, const Eigen::MatrixXi & F) {
+    Eigen::MatrixXd normals(3, F.cols());
 
+    #pragma omp parallel for
     for (int i=0; i<F.cols(); i++) {
+        Eigen::Vector3d v1, v2;
         v1 = V.col(F(1,i)) - V.col(F(0,i));
         v2 = V.col(F(2,i)) - V.col(F(0,i));
         normals.col(i) = ( v1.cross(v2) ).normalized();
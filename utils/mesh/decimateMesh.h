@@ -0,0 +1,231 @@
+/*
+*   decimate a mesh down to a target edge length
+*   by R. Falque
+*   18/10/2026
+*/
+
+#ifndef DECIMATE_MESH_H
+#define DECIMATE_MESH_H
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <stdint.h>
+#include <Eigen/Dense>
+
+// Quadric error metric decimation by vertex clustering (Lindstrom, 2000).
+// Space is cut into cells of size target_edge_length, each cell collapses to
+// the single point minimizing the sum of the plane quadrics of its incident
+// faces, and only the faces spanning three different cells are kept. Every
+// cell is solved independently, so the work runs in parallel over cells.
+// V_out and F_out can alias V and F.
+//
+// The dropped faces are the ones collapsed to an edge or a point and the
+// pairs of faces landing on the same three cells, which leaves no gap: a
+// closed mesh stays closed, as the flood fill of the occupancy grid
+// requires. The faces folded over by the collapse are kept for the same
+// reason, at the cost of a few flipped triangles. The cells are keyed by
+// their indices packed in 64 bits, with as many bits per axis as the extent
+// of the mesh needs; a mesh too large for that (more than 2^64 cells in its
+// bounding box) is returned unchanged with an error.
+inline void decimate_mesh(const Eigen::MatrixXd & V,
+                          const Eigen::MatrixXi & F,
+                          double target_edge_length,
+                          Eigen::MatrixXd & V_out,
+                          Eigen::MatrixXi & F_out)
+{
+    const long int num_vertices = V.cols();
+    const long int num_faces = F.cols();
+    const double inv_cell_size = 1.0 / target_edge_length;
+    const Eigen::Vector3d min_point = V.rowwise().minCoeff();
+
+    // bits of the cell index along each axis
+    const Eigen::Vector3d number_of_cells = ((V.rowwise().maxCoeff() - min_point) * inv_cell_size).array().floor() + 1;
+    int bits[3];
+    for (int k=0; k<3; k++) {
+        bits[k] = 0;
+        while (bits[k] < 64 && std::ldexp(1.0, bits[k]) < number_of_cells(k))
+            bits[k]++;
+    }
+    if (bits[0] + bits[1] + bits[2] > 64) {
+        std::cout << "Error: the mesh spans too many cells of size " << target_edge_length << " to be decimated\n";
+        if (&V_out != &V) V_out = V;
+        if (&F_out != &F) F_out = F;
+        return;
+    }
+    const int shift[3] = {bits[1] + bits[2], bits[2], 0};
+    const uint64_t mask[3] = {bits[0] < 64 ? (uint64_t(1) << bits[0]) - 1 : ~uint64_t(0),
+                              bits[1] < 64 ? (uint64_t(1) << bits[1]) - 1 : ~uint64_t(0),
+                              bits[2] < 64 ? (uint64_t(1) << bits[2]) - 1 : ~uint64_t(0)};
+
+    // cell key of each vertex
+    std::vector<uint64_t> vertex_keys(num_vertices);
+    #pragma omp parallel for
+    for (long int i=0; i<num_vertices; i++) {
+        Eigen::Vector3d cell = ((V.col(i) - min_point) * inv_cell_size).array().floor().min(number_of_cells.array() - 1);
+        vertex_keys[i] = 0;
+        for (int k=0; k<3; k++)
+            if (bits[k] > 0)
+                vertex_keys[i] |= uint64_t(cell(k)) << shift[k];
+    }
+
+    std::vector<uint64_t> cell_keys(vertex_keys);
+    std::sort(cell_keys.begin(), cell_keys.end());
+    cell_keys.erase(std::unique(cell_keys.begin(), cell_keys.end()), cell_keys.end());
+    const long int num_cells = cell_keys.size();
+
+    std::vector<int> vertex_cell(num_vertices);
+    #pragma omp parallel for
+    for (long int i=0; i<num_vertices; i++)
+        vertex_cell[i] = std::lower_bound(cell_keys.begin(), cell_keys.end(), vertex_keys[i]) - cell_keys.begin();
+
+    // area weighted plane quadric of each face, stored as the upper triangle of a 4x4 matrix
+    std::vector< Eigen::Matrix<double, 10, 1> > face_quadrics(num_faces);
+    #pragma omp parallel for
+    for (long int i=0; i<num_faces; i++) {
+        Eigen::Vector3d a = V.col(F(0,i)), b = V.col(F(1,i)), c = V.col(F(2,i));
+        Eigen::Vector3d normal = (b - a).cross(c - a);
+        double double_area = normal.norm();
+        Eigen::Vector4d plane = Eigen::Vector4d::Zero();
+        if (double_area > 0) {
+            normal /= double_area;
+            plane << normal, -normal.dot(a);
+        }
+        double weight = 0.5 * double_area;
+        face_quadrics[i] << plane(0)*plane(0), plane(0)*plane(1), plane(0)*plane(2), plane(0)*plane(3),
+                                               plane(1)*plane(1), plane(1)*plane(2), plane(1)*plane(3),
+                                                                  plane(2)*plane(2), plane(2)*plane(3),
+                                                                                     plane(3)*plane(3);
+        face_quadrics[i] *= weight;
+    }
+
+    // incident faces and vertices of each cell in compressed rows
+    std::vector<int> cell_first_face(num_cells + 1, 0), cell_faces(3 * num_faces);
+    for (long int i=0; i<num_faces; i++)
+        for (int k=0; k<3; k++)
+            cell_first_face[vertex_cell[F(k,i)] + 1]++;
+    for (long int c=0; c<num_cells; c++)
+        cell_first_face[c+1] += cell_first_face[c];
+    std::vector<int> fill(cell_first_face.begin(), cell_first_face.end() - 1);
+    for (long int i=0; i<num_faces; i++)
+        for (int k=0; k<3; k++)
+            cell_faces[fill[vertex_cell[F(k,i)]]++] = i;
+
+    std::vector<int> cell_first_vertex(num_cells + 1, 0), cell_vertices(num_vertices);
+    for (long int i=0; i<num_vertices; i++)
+        cell_first_vertex[vertex_cell[i] + 1]++;
+    for (long int c=0; c<num_cells; c++)
+        cell_first_vertex[c+1] += cell_first_vertex[c];
+    fill.assign(cell_first_vertex.begin(), cell_first_vertex.end() - 1);
+    for (long int i=0; i<num_vertices; i++)
+        cell_vertices[fill[vertex_cell[i]]++] = i;
+
+    // representative point of each cell
+    Eigen::MatrixXd representatives(3, num_cells);
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (long int c=0; c<num_cells; c++) {
+        Eigen::Matrix<double, 10, 1> q = Eigen::Matrix<double, 10, 1>::Zero();
+        for (int j=cell_first_face[c]; j<cell_first_face[c+1]; j++)
+            q += face_quadrics[cell_faces[j]];
+
+        Eigen::Vector3d mean = Eigen::Vector3d::Zero();
+        for (int j=cell_first_vertex[c]; j<cell_first_vertex[c+1]; j++)
+            mean += V.col(cell_vertices[j]);
+        mean /= cell_first_vertex[c+1] - cell_first_vertex[c];
+
+        Eigen::Matrix3d A;
+        A << q(0), q(1), q(2),
+             q(1), q(4), q(5),
+             q(2), q(5), q(7);
+        Eigen::Vector3d b(-q(3), -q(6), -q(8));
+
+        // minimize the quadric around the mean, ignoring the degenerate directions (flat or straight regions)
+        Eigen::JacobiSVD<Eigen::Matrix3d> svd(A, Eigen::ComputeFullU | Eigen::ComputeFullV);
+        Eigen::Vector3d singular_values = svd.singularValues();
+        Eigen::Vector3d inverse_singular_values = Eigen::Vector3d::Zero();
+        for (int k=0; k<3; k++)
+            if (singular_values(k) > 1e-3 * singular_values(0))
+                inverse_singular_values(k) = 1.0 / singular_values(k);
+        Eigen::Vector3d position = mean + svd.matrixV() * inverse_singular_values.asDiagonal() * svd.matrixU().transpose() * (b - A * mean);
+
+        // keep the point in its cell
+        uint64_t key = cell_keys[c];
+        Eigen::Vector3d cell_min;
+        for (int k=0; k<3; k++)
+            cell_min(k) = bits[k] > 0 ? double((key >> shift[k]) & mask[k]) : 0.0;
+        cell_min = cell_min * target_edge_length + min_point;
+        Eigen::Vector3d cell_max = cell_min + Eigen::Vector3d::Constant(target_edge_length);
+        representatives.col(c) = position.cwiseMax(cell_min).cwiseMin(cell_max);
+    }
+
+    // faces spanning three cells, rotated so that the smallest cell comes
+    // first to detect the ones sharing their cells
+    std::vector< Eigen::Vector3i > faces(num_faces);
+    std::vector<char> keep(num_faces);
+    #pragma omp parallel for
+    for (long int i=0; i<num_faces; i++) {
+        Eigen::Vector3i face(vertex_cell[F(0,i)], vertex_cell[F(1,i)], vertex_cell[F(2,i)]);
+        keep[i] = face(0) != face(1) && face(1) != face(2) && face(0) != face(2);
+        int first;
+        face.minCoeff(&first);
+        faces[i] << face(first), face((first+1)%3), face((first+2)%3);
+    }
+
+    std::vector< Eigen::Vector3i > kept_faces;
+    for (long int i=0; i<num_faces; i++)
+        if (keep[i])
+            kept_faces.push_back(faces[i]);
+
+    // Several faces can land on the same three cells, in either orientation
+    // (a thin part collapsed by the clustering). They cancel in pairs, so
+    // that every edge keeps the parity of its number of faces and no hole is
+    // opened; one face of the majority orientation is left if their number is odd.
+    struct FaceLess {
+        bool operator()(const Eigen::Vector3i & a, const Eigen::Vector3i & b) const {
+            const int a_key[4] = {a(0), std::min(a(1), a(2)), std::max(a(1), a(2)), a(1) < a(2)};
+            const int b_key[4] = {b(0), std::min(b(1), b(2)), std::max(b(1), b(2)), b(1) < b(2)};
+            return std::lexicographical_compare(a_key, a_key+4, b_key, b_key+4);
+        }
+    };
+    std::sort(kept_faces.begin(), kept_faces.end(), FaceLess());
+
+    long int num_kept = 0;
+    for (long int i=0; i<kept_faces.size(); ) {
+        long int end = i, positive = 0;
+        while (end < kept_faces.size() && kept_faces[end](0) == kept_faces[i](0) &&
+               std::min(kept_faces[end](1), kept_faces[end](2)) == std::min(kept_faces[i](1), kept_faces[i](2)) &&
+               std::max(kept_faces[end](1), kept_faces[end](2)) == std::max(kept_faces[i](1), kept_faces[i](2))) {
+            positive += kept_faces[end](1) < kept_faces[end](2);
+            end++;
+        }
+        if ((end - i) % 2 == 1) {
+            // the negative faces come first in the group
+            kept_faces[num_kept++] = 2 * positive > end - i ? kept_faces[end - 1] : kept_faces[i];
+        }
+        i = end;
+    }
+    kept_faces.resize(num_kept);
+
+    // drop the cells which are not used by any face
+    std::vector<int> new_index(num_cells, -1);
+    int num_used = 0;
+    for (long int i=0; i<kept_faces.size(); i++)
+        for (int k=0; k<3; k++)
+            if (new_index[kept_faces[i](k)] < 0)
+                new_index[kept_faces[i](k)] = num_used++;
+
+    Eigen::MatrixXd decimated_V(3, num_used);
+    for (long int c=0; c<num_cells; c++)
+        if (new_index[c] >= 0)
+            decimated_V.col(new_index[c]) = representatives.col(c);
+
+    Eigen::MatrixXi decimated_F(3, kept_faces.size());
+    for (long int i=0; i<kept_faces.size(); i++)
+        decimated_F.col(i) << new_index[kept_faces[i](0)], new_index[kept_faces[i](1)], new_index[kept_faces[i](2)];
+
+    V_out.swap(decimated_V);
+    F_out.swap(decimated_F);
+};
+
+#endif
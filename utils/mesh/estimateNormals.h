@@ -0,0 +1,120 @@
+/*
+*   estimate the normals of a point cloud
+*   by R. Falque
+*   18/10/2026
+*/
+
+#ifndef ESTIMATE_NORMALS_H
+#define ESTIMATE_NORMALS_H
+
+#include <iostream>
+#include <vector>
+#include <queue>
+#include <utility>
+#include <functional>
+#include <algorithm>
+#include <cmath>
+#include <Eigen/Dense>
+
+#include "EigenTools/nanoflannWrapper.h"
+
+// Consistent orientation of unoriented normals by propagation along a
+// minimum spanning tree of the k nearest neighbours graph (Hoppe et al.
+// 1992), with the cost 1 - |ni.nj| so that the propagation goes through
+// the flat regions first. Prim's algorithm grows the tree from the point
+// furthest from the centroid, whose normal is made to point away from the
+// centroid, and a normal is flipped when it disagrees with its parent's.
+// Each connected component of the graph gets its own root.
+inline void orient_normals(const Eigen::MatrixXd & V, const Eigen::MatrixXi & neighbours, Eigen::MatrixXd & N) {
+    const long int number_of_points = V.cols();
+    const Eigen::Vector3d centroid = V.rowwise().mean();
+    const Eigen::VectorXd distances = (V.colwise() - centroid).colwise().norm();
+
+    // the knn graph is not symmetric, the reverse edges are added
+    std::vector< std::vector<int> > adjacency(number_of_points);
+    for (long int i = 0; i < number_of_points; ++i)
+        for (int j = 1; j < neighbours.rows(); ++j) {
+            adjacency[i].push_back(neighbours(j, i));
+            adjacency[neighbours(j, i)].push_back(i);
+        }
+
+    // roots by decreasing distance to the centroid
+    std::vector< std::pair<double, long int> > roots(number_of_points);
+    for (long int i = 0; i < number_of_points; ++i)
+        roots[i] = std::make_pair(-distances(i), i);
+    std::sort(roots.begin(), roots.end());
+
+    std::vector< bool > visited(number_of_points, false);
+    typedef std::pair< double, std::pair<int, int> > Edge;     // cost, (parent, child)
+    std::priority_queue< Edge, std::vector<Edge>, std::greater<Edge> > queue;
+
+    for (long int r = 0; r < number_of_points; ++r) {
+        const int root = roots[r].second;
+        if (visited[root])
+            continue;
+
+        if (N.col(root).dot(V.col(root) - centroid) < 0)
+            N.col(root) *= -1;
+        visited[root] = true;
+        for (int j = 0; j < adjacency[root].size(); ++j)
+            queue.push(Edge(1 - std::abs(N.col(root).dot(N.col(adjacency[root][j]))), std::make_pair(root, adjacency[root][j])));
+
+        while (!queue.empty()) {
+            const int parent = queue.top().second.first, child = queue.top().second.second;
+            queue.pop();
+            if (visited[child])
+                continue;
+
+            if (N.col(child).dot(N.col(parent)) < 0)
+                N.col(child) *= -1;
+            visited[child] = true;
+            for (int j = 0; j < adjacency[child].size(); ++j)
+                if (!visited[adjacency[child][j]])
+                    queue.push(Edge(1 - std::abs(N.col(child).dot(N.col(adjacency[child][j]))), std::make_pair(child, adjacency[child][j])));
+        }
+    }
+};
+
+// Normals of a point cloud (3 x n) from the principal axes of the k
+// nearest neighbours of each point: the normal is the eigenvector of the
+// smallest eigenvalue of their covariance. The knn queries go in one
+// parallel batch and the fits are done in parallel, then the normals are
+// oriented consistently (see orient_normals) unless orient is false.
+inline void estimate_normals(const Eigen::MatrixXd & V, int k, Eigen::MatrixXd & N, bool orient = true) {
+    const long int number_of_points = V.cols();
+    N.resize(3, number_of_points);
+    if (number_of_points < 3) {
+        std::cout << "Error: not enough points to estimate the normals\n";
+        N.setZero();
+        return;
+    }
+    k = std::max(3, std::min<int>(k, number_of_points));
+
+    Eigen::MatrixXd points = V;
+    nanoflann_wrapper tree(points);
+    Eigen::MatrixXi neighbours;
+    tree.return_k_closest_points(V, k, neighbours);
+
+    #pragma omp parallel for schedule(static)
+    for (long int i = 0; i < number_of_points; ++i) {
+        Eigen::Vector3d mean = Eigen::Vector3d::Zero();
+        for (int j = 0; j < k; ++j)
+            mean += V.col(neighbours(j, i));
+        mean /= k;
+
+        Eigen::Matrix3d covariance = Eigen::Matrix3d::Zero();
+        for (int j = 0; j < k; ++j) {
+            const Eigen::Vector3d offset = V.col(neighbours(j, i)) - mean;
+            covariance += offset * offset.transpose();
+        }
+
+        Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver;
+        solver.computeDirect(covariance);
+        N.col(i) = solver.eigenvectors().col(0);
+    }
+
+    if (orient)
+        orient_normals(V, neighbours, N);
+};
+
+#endif
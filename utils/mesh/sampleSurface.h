@@ -0,0 +1,87 @@
+/*
+*   area-weighted sampling of a mesh surface
+*   by R. Falque
+*   18/10/2026
+*/
+
+#ifndef SAMPLE_SURFACE_H
+#define SAMPLE_SURFACE_H
+
+#include <cmath>
+#include <vector>
+#include <stdint.h>
+#include <Eigen/Dense>
+
+#include "computeFacesAttributes.h"
+
+// stateless random number in [0, 1) so that each face draws the same values whatever the thread
+inline double hash_to_unit(uint64_t seed, uint64_t a, uint64_t b) {
+    uint64_t z = seed + a * 0x9E3779B97F4A7C15ULL + b * 0xD1B54A32D192ED03ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z = z ^ (z >> 31);
+    return (z >> 11) * (1.0 / 9007199254740992.0);
+};
+
+// Draw about one sample per spacing^2 of surface, uniformly over the area
+// and independently of the tessellation. Each face gets floor(area/spacing^2)
+// samples plus one with the probability of the remainder; the counts are
+// prefix summed so that every face writes its samples in place.
+inline void sample_surface(const Eigen::MatrixXd & V,
+                           const Eigen::MatrixXi & F,
+                           double spacing,
+                           Eigen::MatrixXd & samples,
+                           Eigen::MatrixXd & samples_normals,
+                           Eigen::VectorXi & samples_faces,
+                           Eigen::MatrixXd & samples_barycentric,
+                           uint64_t seed = 0)
+{
+    FacesAttributes attributes;
+    compute_faces_attributes(V, F, attributes);
+
+    const long int num_faces = F.cols();
+    const double density = 1.0 / (spacing * spacing);
+
+    std::vector<long int> first_sample(num_faces + 1, 0);
+    #pragma omp parallel for
+    for (long int i=0; i<num_faces; i++) {
+        double expected = attributes.areas(i) * density;
+        first_sample[i+1] = (long int)(expected + hash_to_unit(seed, i, 0));
+    }
+    for (long int i=0; i<num_faces; i++)
+        first_sample[i+1] += first_sample[i];
+
+    const long int num_samples = first_sample[num_faces];
+    samples.resize(3, num_samples);
+    samples_normals.resize(3, num_samples);
+    samples_faces.resize(num_samples);
+    samples_barycentric.resize(3, num_samples);
+
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (long int i=0; i<num_faces; i++) {
+        for (long int j=first_sample[i]; j<first_sample[i+1]; j++) {
+            // uniform point in the triangle
+            double r1 = std::sqrt(hash_to_unit(seed, i, 2*(j - first_sample[i]) + 1));
+            double r2 = hash_to_unit(seed, i, 2*(j - first_sample[i]) + 2);
+            Eigen::Vector3d barycentric(1 - r1, r1 * (1 - r2), r1 * r2);
+
+            samples.col(j) = barycentric(0) * V.col(F(0,i)) + barycentric(1) * V.col(F(1,i)) + barycentric(2) * V.col(F(2,i));
+            samples_normals.col(j) = attributes.normals.col(i).cast<double>();
+            samples_faces(j) = i;
+            samples_barycentric.col(j) = barycentric;
+        }
+    }
+};
+
+inline void sample_surface(const Eigen::MatrixXd & V,
+                           const Eigen::MatrixXi & F,
+                           double spacing,
+                           Eigen::MatrixXd & samples,
+                           Eigen::MatrixXd & samples_normals)
+{
+    Eigen::VectorXi samples_faces;
+    Eigen::MatrixXd samples_barycentric;
+    sample_surface(V, F, spacing, samples, samples_normals, samples_faces, samples_barycentric);
+};
+
+#endif